@@ -0,0 +1,261 @@
+// Timings for the main algorithms over generated graphs of growing size.
+//
+// usage: bench [-sizes n,n,...] [-repeat r] [-warmup w]
+//              [-baseline file] [-tolerance t] [-out file] [-trace file]
+//
+// Each case runs warmup times untimed, then repeat times timed. One
+// tab separated line is written per case and size:
+//
+//   name  nodes  edges  median_s  p95_s  edges_per_s  peak_rss_kb
+//
+// peak_rss_kb is the peak of the whole process so far, from getrusage,
+// so it only grows from line to line. Lines starting with # are
+// comments. Given a baseline, a file written by an earlier run, each
+// case whose median is slower than the baseline's by more than the
+// tolerance (a fraction, 0.1 by default) is flagged, and the exit
+// status is 1. Given a trace file, the run is traced and written there
+// in the Chrome trace format, for Perfetto.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "edge.h"
+#include "heaps.h"
+#include "random_graphs.h"
+#include "shortest_paths.h"
+#include "walks.h"
+#include "components.h"
+#include "trace.h"
+
+using namespace std;
+using namespace graph;
+
+using weighted_graph_type = graph<weighted_edge<unsigned long, unsigned int> >;
+using basic_graph_type = graph<edge<> >;
+using node_type = unsigned int;
+using weight_type = unsigned long;
+
+class options {
+public:
+    vector<node_type> sizes{10000, 100000};
+    unsigned int repeat{5};
+    unsigned int warmup{1};
+    string baseline;
+    double tolerance{0.1};
+    string out;
+    string trace;
+};
+
+class result {
+public:
+    string name;
+    node_type nodes;
+    size_t edges;
+    double median;
+    double p95;
+    long peak_rss_kb;
+};
+
+long peak_rss_kb()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// times f, after warming up, and sums up the runs
+result measure(const options& o, const string& name, node_type nodes, size_t edges, function<void()> f)
+{
+    for (unsigned int i = 0; i < o.warmup; i++) f();
+    vector<double> times;
+    for (unsigned int i = 0; i < max(o.repeat, 1u); i++) {
+        auto start = chrono::steady_clock::now();
+        f();
+        times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    sort(times.begin(), times.end());
+    size_t p95 = min(times.size() - 1, static_cast<size_t>(times.size() * 0.95));
+    return result{name, nodes, edges, times[times.size() / 2], times[p95], peak_rss_kb()};
+}
+
+void write(ostream& os, const result& r)
+{
+    os << r.name << '\t' << r.nodes << '\t' << r.edges << '\t'
+       << r.median << '\t' << r.p95 << '\t' << r.edges / r.median << '\t'
+       << r.peak_rss_kb << '\n';
+}
+
+// the median of each case in a file written by write
+map<pair<string, node_type>, double> read_baseline(const string& file)
+{
+    map<pair<string, node_type>, double> medians;
+    ifstream in(file);
+    if (!in) {
+        cerr << "cannot read baseline " << file << '\n';
+        exit(2);
+    }
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream fields(line);
+        result r;
+        fields >> r.name >> r.nodes >> r.edges >> r.median;
+        if (fields) medians[make_pair(r.name, r.nodes)] = r.median;
+    }
+    return medians;
+}
+
+vector<result> run(const options& o)
+{
+    vector<result> results;
+    unsigned int seed = 1;
+    for (node_type n : o.sizes) {
+        // road like graphs, with weights from distance
+        node_type side = static_cast<node_type>(sqrt(static_cast<double>(n)));
+        auto by_distance = [](node_type s, node_type t, double d) {
+            return weighted_edge<unsigned long, unsigned int>{s, t, static_cast<weight_type>(1 + 10 * d)};
+        };
+        weighted_graph_type roads;
+        results.push_back(measure(o, "build_spatial", side * side, 0, [&]() {
+                    roads = rnd_spatial<weighted_graph_type>(side, 1.5, 0.5, by_distance, seed);
+                }));
+        results.back().edges = roads.edge_count();
+        weight_type max_weight = 0;
+        for (auto& e : roads) max_weight = max(max_weight, e.weight());
+        size_t m = roads.edge_count();
+
+        results.push_back(measure(o, "dijkstra_dial", side * side, m, [&]() {
+                    dijkstra<weighted_graph_type, heaps::dial_heap>(roads, 0, max_weight);
+                }));
+        results.push_back(measure(o, "dijkstra_radix", side * side, m, [&]() {
+                    dijkstra<weighted_graph_type, heaps::radix_heap>(roads, 0, max_weight);
+                }));
+        results.push_back(measure(o, "dijkstra_pairing", side * side, m, [&]() {
+                    dijkstra<weighted_graph_type, pairing_heap>(roads, 0, max_weight);
+                }));
+        results.push_back(measure(o, "q_lc", side * side, m, [&]() { q_lc(roads, 0); }));
+        results.push_back(measure(o, "dq_lc", side * side, m, [&]() { dq_lc(roads, 0); }));
+
+        // acyclic and skewed: every edge points to an older node
+        auto plain = [](node_type s, node_type t) { return edge<>{s, t}; };
+        basic_graph_type dag;
+        results.push_back(measure(o, "build_preferential", n, 0, [&]() {
+                    dag = rnd_preferential<basic_graph_type>(n, 4, plain, seed);
+                }));
+        results.back().edges = dag.edge_count();
+        results.push_back(measure(o, "top_sort", n, dag.edge_count(), [&]() { top_sort(dag); }));
+        results.push_back(measure(o, "top_levels", n, dag.edge_count(), [&]() { top_levels(dag); }));
+
+        // a chain, one node per level; the same time on one thread as
+        // on many if the narrow levels start no threads
+        basic_graph_type chain;
+        for (node_type k = 0; k + 1 < n; k++) chain += {k, k + 1};
+        results.push_back(measure(o, "top_levels_chain_1", n, chain.edge_count(), [&]() { top_levels(chain, 1); }));
+        results.push_back(measure(o, "top_levels_chain", n, chain.edge_count(), [&]() { top_levels(chain); }));
+
+        // power law, with many cycles
+        unsigned int scale = 0;
+        while ((node_type{1} << (scale + 1)) <= n) scale++;
+        basic_graph_type skewed;
+        results.push_back(measure(o, "build_rmat", node_type{1} << scale, 0, [&]() {
+                    skewed = rnd_rmat<basic_graph_type>(scale, 8, 0.57, 0.19, 0.19, plain, seed);
+                }));
+        results.back().edges = skewed.edge_count();
+        basic_graph_type r = reverse(skewed);
+        results.push_back(measure(o, "scc", node_type{1} << scale, skewed.edge_count(), [&]() { scc(skewed, r); }));
+        results.push_back(measure(o, "pearce_scc", node_type{1} << scale, skewed.edge_count(), [&]() { pearce_scc(skewed); }));
+        results.push_back(measure(o, "par_scc", node_type{1} << scale, skewed.edge_count(), [&]() { par_scc(skewed, r); }));
+
+        // a path into a ring, one node per trim round and search
+        // level; the same time on one thread as on many if the
+        // narrow rounds start no threads
+        basic_graph_type tail;
+        for (node_type k = 0; k + 1 < n; k++) tail += {k, k + 1};
+        tail += {n - 1, n / 2};
+        basic_graph_type tail_r = reverse(tail);
+        results.push_back(measure(o, "par_scc_path_1", n, tail.edge_count(), [&]() { par_scc(tail, tail_r, 1, 0); }));
+        results.push_back(measure(o, "par_scc_path", n, tail.edge_count(), [&]() { par_scc(tail, tail_r, parallel::default_threads(), 0); }));
+    }
+    return results;
+}
+
+options parse(int argc, char* argv[])
+{
+    options o;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "-sizes") {
+            o.sizes.clear();
+            istringstream list(value);
+            string item;
+            while (getline(list, item, ',')) o.sizes.push_back(static_cast<node_type>(atol(item.c_str())));
+        } else if (flag == "-repeat") {
+            o.repeat = atoi(value.c_str());
+        } else if (flag == "-warmup") {
+            o.warmup = atoi(value.c_str());
+        } else if (flag == "-baseline") {
+            o.baseline = value;
+        } else if (flag == "-tolerance") {
+            o.tolerance = atof(value.c_str());
+        } else if (flag == "-out") {
+            o.out = value;
+        } else if (flag == "-trace") {
+            o.trace = value;
+        } else {
+            cerr << "unknown option " << flag << '\n';
+            exit(2);
+        }
+    }
+    return o;
+}
+
+int main(int argc, char* argv[])
+{
+    options o = parse(argc, argv);
+    if (!o.trace.empty()) trace::enable();
+    vector<result> results = run(o);
+    if (!o.trace.empty()) {
+        trace::disable();
+        ofstream out(o.trace);
+        trace::write_chrome_json(out);
+    }
+
+    cout << "# name\tnodes\tedges\tmedian_s\tp95_s\tedges_per_s\tpeak_rss_kb\n";
+    for (auto& r : results) write(cout, r);
+    if (!o.out.empty()) {
+        ofstream out(o.out);
+        out << "# name\tnodes\tedges\tmedian_s\tp95_s\tedges_per_s\tpeak_rss_kb\n";
+        for (auto& r : results) write(out, r);
+    }
+
+    if (o.baseline.empty()) return 0;
+    auto medians = read_baseline(o.baseline);
+    int status = 0;
+    for (auto& r : results) {
+        auto found = medians.find(make_pair(r.name, r.nodes));
+        if (found == medians.end()) continue;
+        if (r.median > found->second * (1 + o.tolerance)) {
+            cout << "# REGRESSION " << r.name << ' ' << r.nodes << ": "
+                 << found->second << "s -> " << r.median << "s\n";
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,184 @@
+// A benchmark in the style of Graph500: build an R-MAT graph, then
+// time breadth first search and shortest paths from sampled roots,
+// checking each result, and report traversed edges per second.
+//
+// usage: graph500 [scale [edge_factor [roots [threads]]]]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "edge.h"
+#include "heaps.h"
+#include "parallel.h"
+#include "random_graphs.h"
+#include "shortest_paths.h"
+#include "walks.h"
+
+using namespace std;
+using namespace graph;
+
+using graph_type = graph<weighted_edge<unsigned long, unsigned int> >;
+using edge_type = graph_type::edge_type;
+using node_type = graph_type::node_type;
+using weight_type = edge_type::weight_type;
+
+const weight_type max_weight = 255;
+
+double seconds_since(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// the same weight both ways along an edge
+weight_type weight_of(node_type s, node_type t)
+{
+    uint64_t a = min(s, t), b = max(s, t);
+    return 1 + random_support::mix((a << 32) | b) % max_weight;
+}
+
+void fail(const string& what, node_type root)
+{
+    cout << "validation failed: " << what << " from root " << root << '\n';
+    exit(1);
+}
+
+// the input edges (each undirected edge once) in the root's component
+double edges_in_component(const graph_type& g, const vector<bool>& reached)
+{
+    double degrees = 0;
+    for (node_type n = 0; n < g.node_count(); n++) if (reached[n]) degrees += g[n].size();
+    return degrees / 2;
+}
+
+double validate_bfs(const graph_type& g, const bfw<graph_type>& walk, node_type root)
+{
+    const node_type token = numeric_limits<node_type>::max();
+    vector<bool> reached(g.node_count());
+    for (node_type n = 0; n < g.node_count(); n++) reached[n] = walk.hops[n] != token;
+    if (walk.hops[root] != 0) fail("root not at level 0", root);
+    for (auto& e : g) {
+        node_type s = e.source(), t = e.target();
+        if (reached[s] != reached[t]) fail("edge leaves the component", root);
+        if (reached[s] && walk.hops[t] > walk.hops[s] + 1) fail("edge skips a level", root);
+    }
+    for (node_type n = 0; n < g.node_count(); n++) {
+        if (!reached[n] || n == root) continue;
+        node_type p = walk.parents[n];
+        if (p == token || !g.contains_edge({p, n}) || walk.hops[p] + 1 != walk.hops[n]) fail("bad parent", root);
+    }
+    return edges_in_component(g, reached);
+}
+
+double validate_sssp(const graph_type& g,
+                     const vector<weight_type>& costs,
+                     const vector<node_type>& parents,
+                     node_type root)
+{
+    const weight_type token = numeric_limits<weight_type>::max();
+    vector<bool> reached(g.node_count());
+    for (node_type n = 0; n < g.node_count(); n++) reached[n] = costs[n] != token;
+    if (costs[root] != 0) fail("root cost not zero", root);
+    for (auto& e : g) {
+        if (reached[e.source()] != reached[e.target()]) fail("edge leaves the component", root);
+        if (reached[e.source()] && costs[e.target()] > costs[e.source()] + e.weight()) fail("edge not relaxed", root);
+    }
+    for (node_type n = 0; n < g.node_count(); n++) {
+        if (!reached[n] || n == root) continue;
+        node_type p = parents[n];
+        if (p == numeric_limits<node_type>::max() || !g.contains_edge({p, n}) ||
+            costs[p] + g.edge_at({p, n}).weight() != costs[n]) fail("bad parent", root);
+    }
+    return edges_in_component(g, reached);
+}
+
+// Graph500 reports quartiles and the harmonic mean of the rates
+void report(const string& kernel, vector<double> times, vector<double> teps)
+{
+    sort(times.begin(), times.end());
+    sort(teps.begin(), teps.end());
+    double inverse = 0;
+    for (double t : teps) inverse += 1 / t;
+    size_t n = teps.size();
+    cout << kernel << "_min_time: " << times.front() << '\n';
+    cout << kernel << "_median_time: " << times[n / 2] << '\n';
+    cout << kernel << "_max_time: " << times.back() << '\n';
+    cout << kernel << "_min_TEPS: " << teps.front() << '\n';
+    cout << kernel << "_firstquartile_TEPS: " << teps[n / 4] << '\n';
+    cout << kernel << "_median_TEPS: " << teps[n / 2] << '\n';
+    cout << kernel << "_thirdquartile_TEPS: " << teps[3 * n / 4] << '\n';
+    cout << kernel << "_max_TEPS: " << teps.back() << '\n';
+    cout << kernel << "_harmonic_mean_TEPS: " << n / inverse << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int scale = argc > 1 ? atoi(argv[1]) : 16;
+    unsigned int edge_factor = argc > 2 ? atoi(argv[2]) : 16;
+    unsigned int root_count = argc > 3 ? atoi(argv[3]) : 16;
+    unsigned int threads = argc > 4 ? atoi(argv[4]) : parallel::default_threads();
+
+    cout << "SCALE: " << scale << '\n';
+    cout << "edgefactor: " << edge_factor << '\n';
+    cout << "NBFS: " << root_count << '\n';
+    cout << "threads: " << threads << '\n';
+
+    // kernel 1: build the graph, with every edge both ways
+    auto start = chrono::steady_clock::now();
+    auto make = [](node_type s, node_type t) { return edge_type{s, t, weight_of(s, t)}; };
+    graph_type g = rnd_rmat<graph_type>(scale, edge_factor, 0.57, 0.19, 0.19, make, 1, threads);
+    vector<edge_type> back;
+    for (auto& e : g) {
+        if (!g.contains_edge({e.target(), e.source()})) back.push_back(reverse_edge(e));
+    }
+    g.insert(back.begin(), back.end());
+    double construction = seconds_since(start);
+    cout << "num_nodes: " << g.node_count() << '\n';
+    cout << "num_edges: " << g.edge_count() << '\n';
+    cout << "construction_time: " << construction << '\n';
+
+    // roots are nodes with at least one edge other than a self loop
+    vector<node_type> roots;
+    mt19937_64 pick(2);
+    for (size_t tries = 0; roots.size() < root_count && tries < 100 * size_t{root_count}; tries++) {
+        node_type n = pick() % g.node_count();
+        bool linked = false;
+        for (auto& e : g[n]) if (e.target() != n) linked = true;
+        if (linked && find(roots.begin(), roots.end(), n) == roots.end()) roots.push_back(n);
+    }
+    if (roots.empty()) {
+        cout << "no roots found\n";
+        return 1;
+    }
+
+    // kernel 2: breadth first search
+    vector<double> times, teps;
+    for (node_type root : roots) {
+        bfw<graph_type> walk{g, threads};
+        start = chrono::steady_clock::now();
+        walk(g, root);
+        double t = seconds_since(start);
+        double edges = validate_bfs(g, walk, root);
+        times.push_back(t);
+        teps.push_back(edges / t);
+    }
+    report("bfs", times, teps);
+
+    // kernel 3: single source shortest paths
+    times.clear();
+    teps.clear();
+    for (node_type root : roots) {
+        start = chrono::steady_clock::now();
+        auto result = dijkstra<graph_type, heaps::radix_heap>(g, root, max_weight);
+        double t = seconds_since(start);
+        double edges = validate_sssp(g, result.first, result.second, root);
+        times.push_back(t);
+        teps.push_back(edges / t);
+    }
+    report("sssp", times, teps);
+}
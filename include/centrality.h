@@ -0,0 +1,316 @@
+// Centrality measures
+// by Veronica Straszheim
+
+#ifndef CENTRALITY_H
+#define CENTRALITY_H
+
+#include <vector>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <type_traits>
+
+#include "heaps.h"
+#include "parallel.h"
+#include "shortest_paths.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       BETWEENNESS
+
+       The betweenness of a node v is, over every pair of other nodes
+       s and t, the share of the shortest paths from s to t that pass
+       through v. It is found by Brandes' method: a search from each
+       source s counts the shortest paths to every node, then a pass
+       back over the nodes, farthest first, adds up what each owes to
+       those beyond it.
+
+       Paths follow the edges as stored, so the graph is directed. An
+       undirected graph, stored with each edge both ways, counts each
+       pair twice; halve the scores for the usual undirected figure.
+
+       As for sssp, the search is chosen from the edge type (see
+       edge_weights): edges without weights are searched breadth
+       first, and edges with weights by Dijkstra's method, with the
+       heap H: by default a dial_heap for integral weights and a
+       pairing_heap for fractional ones. Weights must be positive.
+    **/
+
+    namespace centrality_support {
+
+        /**
+           arcs - the edges of g, flat, each as its target and the
+           cost of crossing it
+
+           The arcs leaving n are targets[first[n]] up to
+           targets[first[n+1]]. Every search walks these rather than
+           g's lists, which are slower to follow.
+        **/
+
+        template<class G>
+        class arcs {
+        public:
+            using node_type = typename G::node_type;
+            using cost_type = typename edge_weights<typename G::edge_type>::cost_type;
+
+            vector<size_t> first;
+            vector<node_type> targets;
+            vector<cost_type> costs;
+            cost_type max_cost{0};
+
+            arcs(const G& g);
+        };
+
+        // the cost of crossing an edge
+        template<class E>
+        typename edge_weights<E>::cost_type step(const E&, false_type)
+        {
+            return 1;
+        }
+
+        template<class E>
+        typename edge_weights<E>::cost_type step(const E& e, true_type)
+        {
+            return static_cast<typename edge_weights<E>::cost_type>(e.weight());
+        }
+
+        template<class E>
+        using weighted = integral_constant<bool, edge_weights<E>::weighted>;
+
+        template<class G>
+        arcs<G>::arcs(const G& g) : first(g.node_count() + 1, 0)
+        {
+            targets.reserve(g.edge_count());
+            costs.reserve(g.edge_count());
+            for (node_type n = 0; n < g.node_count(); n++) {
+                for (auto& e : g[n]) {
+                    targets.push_back(e.target());
+                    costs.push_back(step(e, weighted<typename G::edge_type>{}));
+                    max_cost = max(max_cost, costs.back());
+                }
+                first[n + 1] = targets.size();
+            }
+        }
+
+        // what one thread keeps from search to search; only the
+        // nodes a search reaches are touched, and then reset
+        template<class G>
+        class workspace {
+        public:
+            using node_type = typename G::node_type;
+            using cost_type = typename edge_weights<typename G::edge_type>::cost_type;
+
+            vector<cost_type> costs;
+            vector<double> paths;
+            vector<double> dependency;
+            vector<double> scores;
+
+            // the nodes reached, nearest first
+            vector<node_type> order;
+
+            workspace(node_type count) :
+                costs(count, numeric_limits<cost_type>::max()),
+                paths(count, 0), dependency(count, 0), scores(count, 0) {}
+        };
+
+        // fills costs, paths and order from source_node
+        template<class G, template<class,class> class H, bool W = weighted<typename G::edge_type>::value>
+        class search;
+
+        template<class G, template<class,class> class H>
+        class search<G, H, false> {
+        public:
+            using node_type = typename G::node_type;
+
+            search(const arcs<G>& a) : a(a) {}
+
+            void operator()(node_type source_node, workspace<G>& w)
+            {
+                w.costs[source_node] = 0;
+                w.paths[source_node] = 1;
+                w.order.push_back(source_node);
+                for (size_t i = 0; i < w.order.size(); i++) {
+                    node_type n = w.order[i];
+                    for (size_t k = a.first[n]; k < a.first[n + 1]; k++) {
+                        node_type m = a.targets[k];
+                        if (w.costs[m] == numeric_limits<typename workspace<G>::cost_type>::max()) {
+                            w.costs[m] = w.costs[n] + 1;
+                            w.order.push_back(m);
+                        }
+                        if (w.costs[m] == w.costs[n] + 1) w.paths[m] += w.paths[n];
+                    }
+                }
+            }
+
+        private:
+            const arcs<G>& a;
+        };
+
+        template<class G, template<class,class> class H>
+        class search<G, H, true> {
+        public:
+            using node_type = typename G::node_type;
+            using cost_type = typename workspace<G>::cost_type;
+            using heap_type = H<cost_type, node_type>;
+
+            search(const arcs<G>& a) :
+                a(a), locations(a.first.size() - 1), heap(a.first.size() - 1, a.max_cost) {}
+
+            void operator()(node_type source_node, workspace<G>& w)
+            {
+                const cost_type unreached = numeric_limits<cost_type>::max();
+                heap.clear();
+                w.costs[source_node] = 0;
+                w.paths[source_node] = 1;
+                locations[source_node] = heap.insert(0, source_node);
+                while (!heap.empty()) {
+                    node_type n = heap.find_min();
+                    heap.delete_min();
+                    w.order.push_back(n);
+                    for (size_t k = a.first[n]; k < a.first[n + 1]; k++) {
+                        node_type m = a.targets[k];
+                        cost_type this_cost = w.costs[n] + a.costs[k];
+                        if (w.costs[m] == unreached) {
+                            w.costs[m] = this_cost;
+                            w.paths[m] = w.paths[n];
+                            locations[m] = heap.insert(this_cost, m);
+                        } else if (this_cost < w.costs[m]) {
+                            heap.decrease_key(locations[m], w.costs[m], this_cost);
+                            w.costs[m] = this_cost;
+                            w.paths[m] = w.paths[n];
+                        } else if (this_cost == w.costs[m]) {
+                            w.paths[m] += w.paths[n];
+                        }
+                    }
+                }
+            }
+
+        private:
+            const arcs<G>& a;
+            vector<typename heap_type::location_type> locations;
+
+            // empty after each search, and cleared for the next
+            heap_type heap;
+        };
+
+        /**
+           accumulate - the dependencies of every node on the given
+           sources, summed
+
+           Each thread takes every threads'th source, into its own
+           workspace, and the threads' scores are added up at the end
+           in order of thread, so for a given thread count the result
+           is always the same.
+
+           The pass back finds each node's successors on shortest
+           paths by checking its arcs against the costs, rather than
+           keeping lists of predecessors.
+        **/
+
+        template<template<class,class> class H, class G>
+        vector<double> accumulate(const G& g,
+                                  const vector<typename G::node_type>& sources,
+                                  unsigned int threads)
+        {
+            using node_type = typename G::node_type;
+            threads = max(1u, min<unsigned int>(threads, max<size_t>(sources.size(), 1)));
+
+            arcs<G> a(g);
+            vector<workspace<G> > spaces(threads, workspace<G>(g.node_count()));
+            parallel::parallel_do(threads, [&](unsigned int t) {
+                    workspace<G>& w = spaces[t];
+                    search<G, H> forward(a);
+                    for (size_t i = t; i < sources.size(); i += threads) {
+                        forward(sources[i], w);
+                        for (size_t k = w.order.size(); k-- > 0; ) {
+                            node_type n = w.order[k];
+                            for (size_t j = a.first[n]; j < a.first[n + 1]; j++) {
+                                node_type m = a.targets[j];
+                                if (w.costs[m] == w.costs[n] + a.costs[j]) {
+                                    w.dependency[n] += w.paths[n] / w.paths[m] * (1 + w.dependency[m]);
+                                }
+                            }
+                            if (n != sources[i]) w.scores[n] += w.dependency[n];
+                        }
+                        for (node_type n : w.order) {
+                            w.costs[n] = numeric_limits<typename workspace<G>::cost_type>::max();
+                            w.paths[n] = 0;
+                            w.dependency[n] = 0;
+                        }
+                        w.order.clear();
+                    }
+                });
+
+            vector<double> result = move(spaces[0].scores);
+            for (unsigned int t = 1; t < threads; t++) {
+                for (node_type n = 0; n < g.node_count(); n++) result[n] += spaces[t].scores[n];
+            }
+            return result;
+        }
+    }
+
+    /**
+       betweenness - the exact betweenness of every node
+
+       A search from every node, spread over threads. O(nm) time for
+       edges without weights, O(nm + n^2 log n) with.
+    **/
+
+    template<template<class,class> class H = default_heap, class G>
+    vector<double> betweenness(const G& g,
+                               unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"betweenness"};
+        using node_type = typename G::node_type;
+        vector<node_type> sources(g.node_count());
+        for (node_type n = 0; n < g.node_count(); n++) sources[n] = n;
+        return centrality_support::accumulate<H>(g, sources, threads);
+    }
+
+    /**
+       approximate_betweenness - betweenness from a sample of sources
+
+       Searches from samples sources, picked at random without
+       replacement, and scales the sums by node_count() / samples.
+       Each estimate is unbiased, and its error shrinks as the square
+       root of samples. For a given seed and thread count the result
+       is always the same. With samples of node_count() or more, this
+       is betweenness.
+    **/
+
+    template<template<class,class> class H = default_heap, class G>
+    vector<double> approximate_betweenness(const G& g,
+                                           typename G::node_type samples,
+                                           unsigned int seed = 5050,
+                                           unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"approximate_betweenness"};
+        using node_type = typename G::node_type;
+        const node_type count = g.node_count();
+        vector<node_type> sources(count);
+        for (node_type n = 0; n < count; n++) sources[n] = n;
+        if (samples >= count) return centrality_support::accumulate<H>(g, sources, threads);
+
+        // the first samples of a shuffle
+        mt19937_64 engine(seed);
+        for (node_type i = 0; i < samples; i++) {
+            uniform_int_distribution<node_type> pick(i, count - 1);
+            swap(sources[i], sources[pick(engine)]);
+        }
+        sources.resize(samples);
+
+        vector<double> result = centrality_support::accumulate<H>(g, sources, threads);
+        const double scale = static_cast<double>(count) / max<node_type>(samples, 1);
+        for (auto& score : result) score *= scale;
+        return result;
+    }
+
+}
+
+#endif
+
+// end of file
@@ -0,0 +1,393 @@
+// Parallel algorithms for the components of a graph
+// by Veronica Straszheim
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <vector>
+#include <limits>
+#include <atomic>
+#include <algorithm>
+
+#include "parallel.h"
+#include "trace.h"
+#include "walks.h"
+
+using namespace std;
+
+namespace graph {
+
+    namespace components_support {
+
+        using parallel::atomic_bitmap;
+
+        /**
+           reach - parallel breadth first search, level by level
+
+           Grows seen from frontier (whose nodes must already be set
+           in seen), following edges of g from n to m where allowed(n, m).
+           Each thread gathers its part of the next level in its own
+           buffer; the buffers are joined between levels. Each level
+           gets a team sized to it (see parallel::team_size), so the
+           narrow levels of a long path start no threads.
+        **/
+
+        template<class G, class P>
+        void reach(const G& g,
+                   vector<typename G::node_type> frontier,
+                   atomic_bitmap& seen,
+                   P allowed,
+                   unsigned int threads)
+        {
+            using node_type = typename G::node_type;
+            const size_t chunk = 256;
+            vector<vector<node_type> > next(max(threads, 1u));
+            while (!frontier.empty()) {
+                atomic<size_t> position{0};
+                // clear them all, as threads left out of this level's
+                // team will not
+                for (auto& part : next) part.clear();
+                parallel::parallel_do(parallel::team_size(frontier.size(), threads, chunk), [&](unsigned int t) {
+                        vector<node_type>& out = next[t];
+                        for (size_t b = position.fetch_add(chunk); b < frontier.size(); b = position.fetch_add(chunk)) {
+                            for (size_t i = b; i < min(b + chunk, frontier.size()); i++) {
+                                node_type n = frontier[i];
+                                if (n >= g.node_count()) continue;
+                                for (auto& e : g[n]) {
+                                    node_type m = e.target();
+                                    if (allowed(n, m) && seen.set(m)) out.push_back(m);
+                                }
+                            }
+                        }
+                    });
+                frontier.clear();
+                for (auto& part : next) frontier.insert(frontier.end(), part.begin(), part.end());
+            }
+        }
+
+        // par_scc leaves coloring for Pearce's algorithm once a pass's
+        // rounds look at this many times the nodes left, or a pass
+        // claims less than 1 / color_claim_share of them
+        const size_t color_rounds_limit = 16;
+        const size_t color_claim_share = 16;
+
+        template<class T>
+        bool atomic_max(atomic<T>& a, T v)
+        {
+            T old = a.load(memory_order_relaxed);
+            while (old < v) {
+                if (a.compare_exchange_weak(old, v, memory_order_relaxed)) return true;
+            }
+            return false;
+        }
+    }
+
+    /**
+       PARALLEL STRONGLY CONNECTED COMPONENTS
+    **/
+
+    /**
+       par_scc - strongly connected components, using many threads
+
+       g is a graph, and r is its reverse, computed using reverse(g).
+
+       This runs in stages, after the Multistep method of Slota,
+       Rajamanickam and Madduri:
+
+       1. Trim. A node with no live in edges or no live out edges is
+       a component by itself. Degrees are counted down atomically,
+       so chains of such nodes peel off in one pass.
+
+       2. Forward-backward. From a pivot of large in and out degree,
+       search forward in g and backward in r. The nodes reached both
+       ways are the pivot's component, usually the giant one.
+
+       3. Coloring. Every live node takes the largest node id that
+       can reach it. A node keeping its own id is a root, and the
+       nodes of its color that reach it backward are its component.
+       Each round of pushing colors starts from the nodes the last
+       round changed. Repeat on what is left.
+
+       4. Finish with Pearce's algorithm once serial_cutoff or fewer
+       nodes are left, or once coloring stops paying: when the colors
+       take many rounds to settle, as on long chains, or a pass
+       claims only a small share of the nodes left.
+
+       The searches are level synchronous parallel breadth first
+       searches. The components are numbered in order of their
+       smallest node (see component_set::renumber), so the result
+       can be compared directly with that of pearce_scc, renumbered.
+    **/
+
+    template<class G>
+    component_set<typename G::node_type> par_scc(const G& g,
+                                                 const G& r,
+                                                 unsigned int threads = parallel::default_threads(),
+                                                 size_t serial_cutoff = 10000)
+    {
+        trace::span traced{"par_scc"};
+        using node_type = typename G::node_type;
+        using components_support::atomic_bitmap;
+        using components_support::reach;
+        using parallel::parallel_for;
+
+        const node_type count = g.node_count();
+        const node_type token_node = numeric_limits<node_type>::max();
+
+        // the component of each node, named by one of its members;
+        // token_node while the node is live
+        vector<atomic<node_type> > label(count);
+        for (auto& l : label) l.store(token_node, memory_order_relaxed);
+        auto live = [&](node_type n) { return label[n].load(memory_order_relaxed) == token_node; };
+        auto claim = [&](node_type n, node_type name) {
+            node_type expected = token_node;
+            return label[n].compare_exchange_strong(expected, name, memory_order_relaxed);
+        };
+        auto in_r = [&](node_type n) { return n < r.node_count(); };
+
+        // 1. trim
+        vector<atomic<node_type> > in_degree(count);
+        vector<atomic<node_type> > out_degree(count);
+        parallel_for(0, count, threads, [&](size_t n) {
+                node_type out = 0, in = 0;
+                for (auto& e : g[n]) if (e.target() != n) ++out;
+                if (in_r(n)) for (auto& e : r[n]) if (e.target() != n) ++in;
+                out_degree[n].store(out, memory_order_relaxed);
+                in_degree[n].store(in, memory_order_relaxed);
+            });
+        vector<node_type> trimmed;
+        for (node_type n = 0; n < count; n++) {
+            if (in_degree[n].load() == 0 || out_degree[n].load() == 0) {
+                claim(n, n);
+                trimmed.push_back(n);
+            }
+        }
+        {
+            // each round peels the nodes the last round left without
+            // live in or out edges; like reach, a round gets a team
+            // sized to it
+            const size_t chunk = 256;
+            vector<vector<node_type> > next(max(threads, 1u));
+            while (!trimmed.empty()) {
+                atomic<size_t> position{0};
+                for (auto& part : next) part.clear();
+                parallel::parallel_do(parallel::team_size(trimmed.size(), threads, chunk), [&](unsigned int t) {
+                        vector<node_type>& out = next[t];
+                        for (size_t b = position.fetch_add(chunk); b < trimmed.size(); b = position.fetch_add(chunk)) {
+                            for (size_t i = b; i < min(b + chunk, trimmed.size()); i++) {
+                                node_type n = trimmed[i];
+                                for (auto& e : g[n]) {
+                                    node_type m = e.target();
+                                    if (m != n && in_degree[m].fetch_sub(1) == 1 && claim(m, m)) out.push_back(m);
+                                }
+                                if (!in_r(n)) continue;
+                                for (auto& e : r[n]) {
+                                    node_type m = e.target();
+                                    if (m != n && out_degree[m].fetch_sub(1) == 1 && claim(m, m)) out.push_back(m);
+                                }
+                            }
+                        }
+                    });
+                trimmed.clear();
+                for (auto& part : next) trimmed.insert(trimmed.end(), part.begin(), part.end());
+            }
+        }
+
+        // 2. forward-backward from the pivot
+        node_type pivot = token_node;
+        unsigned long best = 0;
+        for (node_type n = 0; n < count; n++) {
+            if (!live(n)) continue;
+            unsigned long score = static_cast<unsigned long>(in_degree[n].load() + 1) * (out_degree[n].load() + 1);
+            if (pivot == token_node || score > best) {
+                pivot = n;
+                best = score;
+            }
+        }
+        if (pivot != token_node) {
+            atomic_bitmap forward(count);
+            atomic_bitmap backward(count);
+            forward.set(pivot);
+            backward.set(pivot);
+            auto into_live = [&](node_type, node_type m) { return live(m); };
+            reach(g, {pivot}, forward, into_live, threads);
+            reach(r, {pivot}, backward, into_live, threads);
+            parallel_for(0, count, threads, [&](size_t n) {
+                    if (forward.test(n) && backward.test(n)) claim(n, pivot);
+                });
+        }
+
+        // 3. coloring, while it pays
+        vector<atomic<node_type> > color(count);
+        vector<node_type> remaining;
+        for (node_type n = 0; n < count; n++) if (live(n)) remaining.push_back(n);
+        {
+            // the bits of found are only ever set on nodes then
+            // claimed, and queued is emptied after each round, so
+            // neither is cleared between passes
+            const size_t chunk = 256;
+            atomic_bitmap queued(count);
+            atomic_bitmap found(count);
+            vector<vector<node_type> > next(max(threads, 1u));
+            while (remaining.size() > serial_cutoff) {
+                for (node_type n : remaining) color[n].store(n, memory_order_relaxed);
+                // push the largest colors forward, each round from the
+                // nodes the last one changed, until nothing changes or
+                // the rounds have looked at color_rounds_limit times
+                // the nodes left
+                vector<node_type> frontier = remaining;
+                size_t work = 0;
+                while (!frontier.empty() && work <= components_support::color_rounds_limit * remaining.size()) {
+                    work += frontier.size();
+                    atomic<size_t> position{0};
+                    for (auto& part : next) part.clear();
+                    parallel::parallel_do(parallel::team_size(frontier.size(), threads, chunk), [&](unsigned int t) {
+                            vector<node_type>& out = next[t];
+                            for (size_t b = position.fetch_add(chunk); b < frontier.size(); b = position.fetch_add(chunk)) {
+                                for (size_t i = b; i < min(b + chunk, frontier.size()); i++) {
+                                    node_type n = frontier[i];
+                                    node_type c = color[n].load(memory_order_relaxed);
+                                    for (auto& e : g[n]) {
+                                        node_type m = e.target();
+                                        if (live(m) && components_support::atomic_max(color[m], c) && queued.set(m)) out.push_back(m);
+                                    }
+                                }
+                            }
+                        });
+                    frontier.clear();
+                    for (auto& part : next) frontier.insert(frontier.end(), part.begin(), part.end());
+                    for (node_type n : frontier) queued.reset(n);
+                }
+                // the colors have not settled, as on a long chain,
+                // where each round moves a color one node on
+                if (!frontier.empty()) break;
+
+                // each root gathers the nodes of its color that reach it
+                vector<node_type> roots;
+                for (node_type n : remaining) if (color[n].load() == n) roots.push_back(n);
+                for (node_type n : roots) found.set(n);
+                reach(r, roots, found, [&](node_type n, node_type m) {
+                        return live(m) && color[m].load(memory_order_relaxed) == color[n].load(memory_order_relaxed);
+                    }, threads);
+                parallel_for(0, remaining.size(), threads, [&](size_t i) {
+                        node_type n = remaining[i];
+                        if (found.test(n)) claim(n, color[n].load(memory_order_relaxed));
+                    });
+                vector<node_type> left;
+                for (node_type n : remaining) if (live(n)) left.push_back(n);
+                // a pass that claims only a few nodes, as when each
+                // root's component is small, would be repeated about
+                // as many times as there are nodes left
+                bool few = (remaining.size() - left.size()) * components_support::color_claim_share < remaining.size();
+                swap(remaining, left);
+                if (few) break;
+            }
+        }
+
+        // 4. the rest, serially
+        component_set<node_type> result;
+        result.ids.assign(count, 0);
+        if (!remaining.empty()) {
+            vector<node_type>& rindex = result.ids;
+            size_t found = walk_support::pearce(g, live, rindex);
+            // name each component after its first member
+            vector<node_type> names(found, token_node);
+            for (node_type n : remaining) {
+                node_type& name = names[count - 1 - rindex[n]];
+                if (name == token_node) name = n;
+                label[n].store(name, memory_order_relaxed);
+            }
+        }
+
+        for (node_type n = 0; n < count; n++) result.ids[n] = label[n].load(memory_order_relaxed);
+        result.renumber();
+        return result;
+    }
+
+
+    /**
+       CONNECTED COMPONENTS
+    **/
+
+    namespace components_support {
+
+        // the root of n, halving the path on the way up
+        template<class N>
+        N find_root(vector<atomic<N> >& parent, N n)
+        {
+            for (;;) {
+                N p = parent[n].load(memory_order_relaxed);
+                if (p == n) return n;
+                N grandparent = parent[p].load(memory_order_relaxed);
+                if (p != grandparent) parent[n].compare_exchange_weak(p, grandparent, memory_order_relaxed);
+                n = grandparent;
+            }
+        }
+
+        // join the trees of a and b, hanging the larger root below
+        // the smaller, so no cycle can form
+        template<class N>
+        void unite(vector<atomic<N> >& parent, N a, N b)
+        {
+            for (;;) {
+                a = find_root(parent, a);
+                b = find_root(parent, b);
+                if (a == b) return;
+                if (a < b) swap(a, b);
+                N expected = a;
+                if (parent[a].compare_exchange_strong(expected, b, memory_order_relaxed)) return;
+            }
+        }
+    }
+
+    /**
+       connected_components - the weakly connected components of g
+
+       Treats every edge as undirected, so no reverse graph is needed.
+       Each thread takes ranges of source nodes and joins the ends of
+       their edges in a shared union-find forest. Links and path
+       halving are single compare and swaps, so there are no locks;
+       a root always hangs below a smaller node, so the forest stays
+       acyclic and each root ends up the smallest node of its
+       component.
+
+       The result's ids give the component of each node, and size(c)
+       the number of nodes in component c. Components are numbered in
+       order of their smallest node.
+    **/
+
+    template<class G>
+    component_set<typename G::node_type> connected_components(const G& g,
+                                                              unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"connected_components"};
+        using node_type = typename G::node_type;
+        using components_support::find_root;
+        const node_type count = g.node_count();
+
+        vector<atomic<node_type> > parent(count);
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                parent[n].store(static_cast<node_type>(n), memory_order_relaxed);
+            });
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                for (auto& e : g[n]) {
+                    // most edges join trees already joined; check cheaply first
+                    if (parent[e.source()].load(memory_order_relaxed) == parent[e.target()].load(memory_order_relaxed)) continue;
+                    components_support::unite(parent, e.source(), e.target());
+                }
+            }, 256);
+
+        component_set<node_type> result;
+        result.ids.resize(count);
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                result.ids[n] = find_root(parent, static_cast<node_type>(n));
+            });
+        result.renumber();
+        return result;
+    }
+
+}
+
+#endif
+
+// end of file
@@ -0,0 +1,284 @@
+// Distances between many sources and many targets
+// by Veronica Straszheim
+
+#ifndef DISTANCE_TABLES_H
+#define DISTANCE_TABLES_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <tuple>
+#include <atomic>
+#include <memory>
+
+#include "parallel.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       DIJKSTRA WORKSPACE
+    **/
+
+    /**
+       dijkstra_workspace - reusable state for repeated Dijkstra searches
+
+       Holds the costs, heap and heap locations for one search at a
+       time. Only the entries a search touched are reset before the
+       next, and the heap is cleared rather than built again, so many
+       searches that each stop early cost what they explore, not what
+       the graph (or the dial heap's buckets) holds.
+
+       One workspace per thread; the graph itself is only read.
+    **/
+
+    template<class G, template<class,class> class H>
+    class dijkstra_workspace {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+        using heap_type = H<weight_type, node_type>;
+        const weight_type token_cost = numeric_limits<weight_type>::max();
+
+        vector<weight_type> costs;
+
+        dijkstra_workspace(const G& g) :
+            costs(g.node_count(), token_cost),
+            locations(g.node_count()),
+            settled(g.node_count(), false) {}
+
+        /**
+           search - Dijkstra from source_node
+
+           Stops once every node marked in is_target is settled, or
+           when wanted is zero, once the heap runs out. Afterwards
+           costs holds the final cost of every settled node.
+        **/
+
+        void search(const G& g,
+                    node_type source_node,
+                    weight_type max_edge_cost,
+                    const vector<bool>& is_target,
+                    size_t wanted);
+
+    private:
+        vector<typename heap_type::location_type> locations;
+        vector<bool> settled;
+        vector<node_type> touched;
+
+        // built on the first search, and again only if the
+        // max_edge_cost changes
+        unique_ptr<heap_type> heap;
+        weight_type heap_max_edge_cost{0};
+
+        void reset();
+    };
+
+    template<class G, template<class,class> class H>
+    void dijkstra_workspace<G,H>::reset()
+    {
+        for (node_type n : touched) {
+            costs[n] = token_cost;
+            settled[n] = false;
+        }
+        touched.clear();
+    }
+
+    template<class G, template<class,class> class H>
+    void dijkstra_workspace<G,H>::search(const G& g,
+                                         node_type source_node,
+                                         weight_type max_edge_cost,
+                                         const vector<bool>& is_target,
+                                         size_t wanted)
+    {
+        reset();
+        if (!heap || heap_max_edge_cost != max_edge_cost) {
+            heap.reset(new heap_type(g.node_count(), max_edge_cost));
+            heap_max_edge_cost = max_edge_cost;
+        } else {
+            heap->clear();
+        }
+        costs[source_node] = 0;
+        touched.push_back(source_node);
+        locations[source_node] = heap->insert(0, source_node);
+
+        while (!heap->empty()) {
+            node_type node = heap->find_min();
+            heap->delete_min();
+            settled[node] = true;
+            if (wanted > 0 && is_target[node] && --wanted == 0) return;
+            for (auto& edge : g[node]) {
+                node_type t = edge.target();
+                if (settled[t]) continue;
+                weight_type this_cost = costs[node] + edge.weight();
+                if (costs[t] == token_cost) {
+                    costs[t] = this_cost;
+                    touched.push_back(t);
+                    locations[t] = heap->insert(this_cost, t);
+                } else if (this_cost < costs[t]) {
+                    heap->decrease_key(locations[t], costs[t], this_cost);
+                    costs[t] = this_cost;
+                }
+            }
+        }
+    }
+
+    /**
+       MANY TO MANY
+    **/
+
+    /**
+       distance_table - the cost from each source to each target
+
+       Returns a flat, row major table: the cost from sources[i] to
+       targets[j] is at [i * targets.size() + j]. Unreachable pairs
+       hold the maximum value of the weight type.
+
+       One Dijkstra search runs per source, spread over threads, each
+       with its own workspace. A search stops as soon as every target
+       is settled, rather than settling the whole graph.
+
+       H is a heap from heaps.h, as for dijkstra.
+    **/
+
+    template<class G, template<class,class> class H>
+    vector<typename G::edge_type::weight_type>
+    distance_table(const G& g,
+                   const vector<typename G::node_type>& sources,
+                   const vector<typename G::node_type>& targets,
+                   typename G::edge_type::weight_type max_edge_cost,
+                   unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"distance_table"};
+        using node_type = typename G::node_type;
+        using weight_type = typename G::edge_type::weight_type;
+
+        vector<weight_type> result(sources.size() * targets.size());
+        if (result.empty()) return result;
+        vector<bool> is_target(g.node_count(), false);
+        size_t wanted = 0;
+        for (node_type t : targets) {
+            if (!is_target[t]) ++wanted;
+            is_target[t] = true;
+        }
+
+        atomic<size_t> next_row{0};
+        threads = min<size_t>(threads, sources.size());
+        parallel::parallel_do(threads, [&](unsigned int) {
+                dijkstra_workspace<G,H> work{g};
+                for (size_t row = next_row++; row < sources.size(); row = next_row++) {
+                    work.search(g, sources[row], max_edge_cost, is_target, wanted);
+                    weight_type* out = &result[row * targets.size()];
+                    for (size_t j = 0; j < targets.size(); j++) out[j] = work.costs[targets[j]];
+                }
+            });
+        return result;
+    }
+
+    /**
+       distance_table - as above, but computes the max_edge_cost
+    **/
+
+    template<class G, template<class,class> class H>
+    vector<typename G::edge_type::weight_type>
+    distance_table(const G& g,
+                   const vector<typename G::node_type>& sources,
+                   const vector<typename G::node_type>& targets)
+    {
+        using weight_type = typename G::edge_type::weight_type;
+        weight_type max_edge_cost = 0;
+        for (auto& e : g) {
+            if (e.weight() > max_edge_cost) max_edge_cost = e.weight();
+        }
+        return distance_table<G,H>(g, sources, targets, max_edge_cost);
+    }
+
+    /**
+       MULTIPLE SOURCES
+    **/
+
+    /**
+       nearest_source - one search from all the sources at once
+
+       Every source starts at cost zero, so each node is settled from
+       whichever source is closest. Returns the costs and parents, as
+       dijkstra does, plus the nearest source of each node (the
+       maximum node value where none reaches).
+    **/
+
+    template<class G, template<class,class> class H>
+    tuple<vector<typename G::edge_type::weight_type>,
+          vector<typename G::node_type>,
+          vector<typename G::node_type> >
+    nearest_source(const G& g,
+                   const vector<typename G::node_type>& sources,
+                   typename G::edge_type::weight_type max_edge_cost)
+    {
+        trace::span traced{"nearest_source"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+        const weight_type token_cost = numeric_limits<weight_type>::max();
+
+        vector<weight_type> costs(g.node_count(), token_cost);
+        vector<node_type> parents(g.node_count(), numeric_limits<node_type>::max());
+        vector<node_type> labels(g.node_count(), numeric_limits<node_type>::max());
+
+        H<weight_type, node_type> heap(g.node_count(), max_edge_cost);
+        vector<typename decltype(heap)::location_type> locations(g.node_count());
+
+        for (node_type s : sources) {
+            if (costs[s] == 0) continue;
+            costs[s] = 0;
+            labels[s] = s;
+            locations[s] = heap.insert(0, s);
+        }
+
+        while(!heap.empty()) {
+            node_type node = heap.find_min();
+            heap.delete_min();
+            for (auto& edge : g[node]) {
+                weight_type this_cost = costs[node] + edge.weight();
+                if (costs[edge.target()] == token_cost) {
+                    costs[edge.target()] = this_cost;
+                    parents[edge.target()] = node;
+                    labels[edge.target()] = labels[node];
+                    locations[edge.target()] = heap.insert(this_cost, edge.target());
+                } else if (this_cost < costs[edge.target()]) {
+                    parents[edge.target()] = node;
+                    labels[edge.target()] = labels[node];
+                    heap.decrease_key(locations[edge.target()], costs[edge.target()], this_cost);
+                    costs[edge.target()] = this_cost;
+                }
+            }
+        }
+        return make_tuple(costs, parents, labels);
+    }
+
+    /**
+       nearest_source - as above, but computes the max_edge_cost
+    **/
+
+    template<class G, template<class,class> class H>
+    tuple<vector<typename G::edge_type::weight_type>,
+          vector<typename G::node_type>,
+          vector<typename G::node_type> >
+    nearest_source(const G& g,
+                   const vector<typename G::node_type>& sources)
+    {
+        using weight_type = typename G::edge_type::weight_type;
+        weight_type max_edge_cost = 0;
+        for (auto& e : g) {
+            if (e.weight() > max_edge_cost) max_edge_cost = e.weight();
+        }
+        return nearest_source<G,H>(g, sources, max_edge_cost);
+    }
+
+}
+
+#endif
+
+// end of file
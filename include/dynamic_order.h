@@ -0,0 +1,234 @@
+// Topological order kept up to date as the graph grows
+// by Veronica Straszheim
+
+#ifndef DYNAMIC_ORDER_H
+#define DYNAMIC_ORDER_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "walks.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       DYNAMIC TOPOLOGICAL ORDER
+    **/
+
+    /**
+       dynamic_top_order - a topological order, repaired in place
+
+       This keeps a topological order of g as edges are added through
+       operator+=, after Pearce and Kelly. An edge that already runs
+       forward in the order changes nothing. Otherwise, from s -> t:
+
+       1. Search forward from t, over the nodes placed no later than
+       s. Reaching s means the edge would close a cycle.
+
+       2. Search backward from s, over the nodes placed after t.
+
+       3. The nodes found take the same set of positions, those
+       found backward first, each group keeping its old order.
+
+       So an insertion costs in proportion to the region between t
+       and s, not to the whole graph.
+
+       Changes must go through this class (not g directly), so that
+       the reverse adjacency kept here stays in step with g.
+    **/
+
+    template<class G>
+    class dynamic_top_order {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using location_type = typename G::location_type;
+        const node_type token_node = numeric_limits<node_type>::max();
+
+        // throws cycle_found if g is not acyclic
+        dynamic_top_order(G& g_);
+
+        // the nodes, in topological order
+        const vector<node_type>& order() const { return nodes; }
+
+        // where n is in the order
+        node_type position(node_type n) const { return positions[n]; }
+
+        /**
+           operator+= - add e to g, and repair the order
+
+           If e would close a cycle, g is left alone and cycle_found
+           is thrown, holding e and parents leading from e's source
+           round to its target.
+        **/
+
+        dynamic_top_order& operator+=(edge_type e);
+
+        // removing an edge never breaks the order
+        void delete_edge(location_type l);
+
+    private:
+        G& g;
+        G r;
+        vector<node_type> nodes;
+        vector<node_type> positions;
+
+        // workspace, cleared after each repair
+        vector<bool> visited;
+        vector<node_type> tree;
+        vector<node_type> forward;
+        vector<node_type> backward;
+        vector<node_type> stack;
+
+        void grow(node_type n);
+        bool search_forward(node_type t, node_type s, vector<node_type>& parents);
+        void search_backward(node_type s, node_type bound);
+        void reorder();
+    };
+
+    template<class G>
+    dynamic_top_order<G>::dynamic_top_order(G& g_) :
+        g(g_), r(reverse(g_))
+    {
+        nodes = top_sort(g);
+        std::reverse(nodes.begin(), nodes.end());
+        positions.resize(nodes.size());
+        for (node_type i = 0; i < nodes.size(); i++) positions[nodes[i]] = i;
+        visited.resize(nodes.size(), false);
+        tree.resize(nodes.size());
+    }
+
+    // new nodes go at the end of the order
+    template<class G>
+    void dynamic_top_order<G>::grow(node_type n)
+    {
+        while (nodes.size() < n) {
+            positions.push_back(nodes.size());
+            nodes.push_back(nodes.size());
+        }
+        visited.resize(n, false);
+        tree.resize(n);
+    }
+
+    // depth first from t, over nodes no later than s; returns true
+    // if s is reached, with parents leading from s back to t
+    template<class G>
+    bool dynamic_top_order<G>::search_forward(node_type t, node_type s, vector<node_type>& parents)
+    {
+        const node_type bound = positions[s];
+        stack.push_back(t);
+        visited[t] = true;
+        forward.push_back(t);
+        while (!stack.empty()) {
+            node_type n = stack.back();
+            stack.pop_back();
+            if (n >= g.node_count()) continue;
+            for (auto& e : g[n]) {
+                node_type m = e.target();
+                if (m == s) {
+                    parents.assign(nodes.size(), token_node);
+                    for (node_type f : forward) {
+                        parents[f] = tree[f];
+                        visited[f] = false;
+                    }
+                    parents[t] = token_node;
+                    parents[s] = n;
+                    forward.clear();
+                    stack.clear();
+                    return true;
+                }
+                if (visited[m] || positions[m] > bound) continue;
+                visited[m] = true;
+                tree[m] = n;
+                forward.push_back(m);
+                stack.push_back(m);
+            }
+        }
+        return false;
+    }
+
+    // depth first from s in r, over nodes after bound
+    template<class G>
+    void dynamic_top_order<G>::search_backward(node_type s, node_type bound)
+    {
+        stack.push_back(s);
+        visited[s] = true;
+        backward.push_back(s);
+        while (!stack.empty()) {
+            node_type n = stack.back();
+            stack.pop_back();
+            if (n >= r.node_count()) continue;
+            for (auto& e : r[n]) {
+                node_type m = e.target();
+                if (visited[m] || positions[m] <= bound) continue;
+                visited[m] = true;
+                backward.push_back(m);
+                stack.push_back(m);
+            }
+        }
+    }
+
+    // give the nodes found the positions they held between them,
+    // backward ones first
+    template<class G>
+    void dynamic_top_order<G>::reorder()
+    {
+        auto earlier = [&](node_type a, node_type b) { return positions[a] < positions[b]; };
+        sort(forward.begin(), forward.end(), earlier);
+        sort(backward.begin(), backward.end(), earlier);
+
+        vector<node_type> slots;
+        slots.reserve(forward.size() + backward.size());
+        for (node_type n : backward) slots.push_back(positions[n]);
+        for (node_type n : forward) slots.push_back(positions[n]);
+        sort(slots.begin(), slots.end());
+
+        size_t i = 0;
+        for (node_type n : backward) nodes[slots[i++]] = n;
+        for (node_type n : forward) nodes[slots[i++]] = n;
+        for (size_t j = 0; j < slots.size(); j++) {
+            positions[nodes[slots[j]]] = slots[j];
+            visited[nodes[slots[j]]] = false;
+        }
+        forward.clear();
+        backward.clear();
+    }
+
+    template<class G>
+    dynamic_top_order<G>& dynamic_top_order<G>::operator+=(edge_type e)
+    {
+        node_type s = e.source();
+        node_type t = e.target();
+        grow(max(s, t) + 1);
+        if (s == t) {
+            vector<node_type> parents(nodes.size(), token_node);
+            throw cycle_found<edge_type>{e, parents, "Cycle found"};
+        }
+        if (positions[t] < positions[s]) {
+            vector<node_type> parents;
+            if (search_forward(t, s, parents)) {
+                throw cycle_found<edge_type>{e, parents, "Cycle found"};
+            }
+            search_backward(s, positions[t]);
+            reorder();
+        }
+        g += e;
+        r += reverse_edge(e);
+        return *this;
+    }
+
+    template<class G>
+    void dynamic_top_order<G>::delete_edge(location_type l)
+    {
+        g.delete_edge(l);
+        r.delete_edge({l.second, l.first});
+    }
+
+}
+
+#endif
+
+// end of file
@@ -0,0 +1,247 @@
+// Shortest paths kept up to date as the graph changes
+// by Veronica Straszheim
+
+#ifndef DYNAMIC_PATHS_H
+#define DYNAMIC_PATHS_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+
+#include "heaps.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       DYNAMIC SINGLE SOURCE SHORTEST PATHS
+    **/
+
+    /**
+       A single change to a graph, for dynamic_paths::apply
+
+       insert adds edge; if the graph already holds an edge at that
+       location, it is treated as a reweight.
+
+       remove deletes the edge at edge's location; its weight is
+       ignored. Removing an edge that is not there does nothing.
+
+       reweight sets the weight of the edge at edge's location to
+       edge.weight().
+    **/
+
+    enum class edge_change { insert, remove, reweight };
+
+    template<class E>
+    class edge_update {
+    public:
+        edge_change change;
+        E edge;
+        edge_update(edge_change c, E e) : change{c}, edge{e} {};
+    };
+
+    /**
+       dynamic_paths - shortest paths from one source, repaired in place
+
+       This owns the costs and parents of a shortest path tree over
+       g, as dijkstra would compute them, and keeps them correct as
+       edges of g are inserted, removed and reweighted through it.
+       Only the affected part of the tree is recomputed, after the
+       manner of Ramalingam and Reps:
+
+       1. Every node below an edge of the tree that was removed or
+       made heavier loses its label.
+
+       2. Those nodes are seeded from their unaffected in-neighbors,
+       and the targets of inserted or lightened edges are seeded
+       from the edge.
+
+       3. A Dijkstra search runs from the seeds only, and stops when
+       no label can improve.
+
+       Changes must go through this class (not g directly), so that
+       the reverse adjacency kept here stays in step with g. Weights
+       must be non-negative.
+
+       Since the seeds do not follow the integral heap constraints
+       (see heaps.h), the pairing heap is used.
+    **/
+
+    template<class G>
+    class dynamic_paths {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+        using location_type = typename G::location_type;
+        using update_type = edge_update<edge_type>;
+        const node_type token_node = numeric_limits<node_type>::max();
+        const weight_type token_cost = numeric_limits<weight_type>::max();
+
+        dynamic_paths(G& g_, node_type source);
+
+        const vector<weight_type>& costs() const { return cost; }
+        const vector<node_type>& parents() const { return parent; }
+        node_type source() const { return source_node; }
+
+        // apply a batch of changes, then repair the tree once
+        void apply(const vector<update_type>& batch);
+
+        void insert_edge(edge_type e) { apply({update_type{edge_change::insert, e}}); }
+        void delete_edge(edge_type e) { apply({update_type{edge_change::remove, e}}); }
+        void set_weight(edge_type e) { apply({update_type{edge_change::reweight, e}}); }
+
+    private:
+        using heap_type = pairing_heap<weight_type, node_type>;
+
+        G& g;
+        G r;
+        node_type source_node;
+        vector<weight_type> cost;
+        vector<node_type> parent;
+
+        // workspace, cleared after each repair
+        vector<bool> affected;
+        vector<bool> in_heap;
+        vector<typename heap_type::location_type> locations;
+
+        void grow(node_type n);
+        void relabel(heap_type& heap, node_type from, node_type to, weight_type c);
+        void search(heap_type& heap);
+    };
+
+    template<class G>
+    dynamic_paths<G>::dynamic_paths(G& g_, node_type source) :
+        g(g_), r(reverse(g_)), source_node{source}
+    {
+        grow(max(g.node_count(), static_cast<node_type>(source + 1)));
+        heap_type heap(g.node_count(), 0);
+        cost[source_node] = 0;
+        locations[source_node] = heap.insert(0, source_node);
+        in_heap[source_node] = true;
+        search(heap);
+    }
+
+    template<class G>
+    void dynamic_paths<G>::grow(node_type n)
+    {
+        if (n <= cost.size()) return;
+        cost.resize(n, token_cost);
+        parent.resize(n, token_node);
+        affected.resize(n, false);
+        in_heap.resize(n, false);
+        locations.resize(n);
+    }
+
+    // lower the label of to, reached by way of from
+    template<class G>
+    void dynamic_paths<G>::relabel(heap_type& heap, node_type from, node_type to, weight_type c)
+    {
+        if (in_heap[to]) {
+            heap.decrease_key(locations[to], cost[to], c);
+        } else {
+            locations[to] = heap.insert(c, to);
+            in_heap[to] = true;
+        }
+        cost[to] = c;
+        parent[to] = from;
+    }
+
+    template<class G>
+    void dynamic_paths<G>::search(heap_type& heap)
+    {
+        while (!heap.empty()) {
+            node_type n = heap.find_min();
+            heap.delete_min();
+            in_heap[n] = false;
+            if (n >= g.node_count()) continue;
+            for (auto& e : g[n]) {
+                weight_type c = cost[n] + e.weight();
+                if (c < cost[e.target()]) relabel(heap, n, e.target(), c);
+            }
+        }
+    }
+
+    template<class G>
+    void dynamic_paths<G>::apply(const vector<update_type>& batch)
+    {
+        // roots of subtrees whose paths got longer, and edges that
+        // may offer shorter paths
+        vector<node_type> roots;
+        vector<location_type> seeds;
+
+        for (auto& u : batch) {
+            edge_type e = u.edge;
+            location_type l{e.source(), e.target()};
+            grow(max(e.source(), e.target()) + 1);
+            edge_change change = u.change;
+            if (change == edge_change::insert && g.contains_edge(l)) change = edge_change::reweight;
+            switch (change) {
+            case edge_change::insert:
+                g += e;
+                r += reverse_edge(e);
+                seeds.push_back(l);
+                break;
+            case edge_change::remove:
+                if (!g.contains_edge(l)) break;
+                g.delete_edge(l);
+                r.delete_edge({l.second, l.first});
+                if (parent[e.target()] == e.source()) roots.push_back(e.target());
+                break;
+            case edge_change::reweight: {
+                if (!g.contains_edge(l)) break;
+                weight_type old = g.edge_at(l).weight();
+                g.edge_at(l).weight() = e.weight();
+                r.edge_at({l.second, l.first}).weight() = e.weight();
+                if (e.weight() < old) seeds.push_back(l);
+                else if (old < e.weight() && parent[e.target()] == e.source()) roots.push_back(e.target());
+                break;
+            }
+            }
+        }
+
+        // 1. collect the subtrees below the roots
+        vector<node_type> lost;
+        while (!roots.empty()) {
+            node_type n = roots.back();
+            roots.pop_back();
+            if (affected[n]) continue;
+            affected[n] = true;
+            lost.push_back(n);
+            for (auto& e : g[n]) {
+                if (parent[e.target()] == n && !affected[e.target()]) roots.push_back(e.target());
+            }
+        }
+        for (node_type n : lost) {
+            cost[n] = token_cost;
+            parent[n] = token_node;
+        }
+
+        // 2. seed the heap
+        heap_type heap(g.node_count(), 0);
+        for (node_type n : lost) {
+            if (n >= r.node_count()) continue;
+            for (auto& e : r[n]) {
+                node_type from = e.target();
+                if (affected[from] || cost[from] == token_cost) continue;
+                weight_type c = cost[from] + e.weight();
+                if (c < cost[n]) relabel(heap, from, n, c);
+            }
+        }
+        for (auto& l : seeds) {
+            if (!g.contains_edge(l) || cost[l.first] == token_cost) continue;
+            weight_type c = cost[l.first] + g.edge_at(l).weight();
+            if (c < cost[l.second]) relabel(heap, l.first, l.second, c);
+        }
+        for (node_type n : lost) affected[n] = false;
+
+        // 3. and search out from them
+        search(heap);
+    }
+
+}
+
+#endif
+
+// end of file
@@ -0,0 +1,380 @@
+// Maximum flows and minimum cuts
+// by Veronica Straszheim
+
+#ifndef FLOW_H
+#define FLOW_H
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "graph.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       MAXIMUM FLOW
+    **/
+
+    /**
+       flow_result - what max_flow finds
+
+       value: the flow from source to sink, equal to the capacity of
+       the cut
+
+       flows: each edge of g, in the order g iterates them, with its
+       weight the flow along it (a graph of them is a flows.begin(),
+       flows.end() insert away, but costs more to build than the
+       flow does to find)
+
+       source_side: the nodes on the source's side of a minimum cut,
+       those still reachable from the source by edges with capacity
+       to spare
+
+       cut: the edges of g from the source side to the sink side; each
+       is saturated, and their capacities add up to value
+    **/
+
+    template<class G>
+    class flow_result {
+    public:
+        using edge_type = typename G::edge_type;
+        using weight_type = typename edge_type::weight_type;
+
+        weight_type value{0};
+        vector<edge_type> flows;
+        vector<bool> source_side;
+        vector<edge_type> cut;
+    };
+
+    namespace flow_support {
+
+        /**
+           push_relabel - the residual graph, and the work on it
+
+           The residual graph is a flat array of arcs, those leaving
+           node n from first[n] up to first[n+1]. Each edge of g is
+           an arc forward, holding the capacity left, and an arc back,
+           holding the flow that could be undone; each knows the
+           other's index.
+
+           Each node has a height, never more than one above the next
+           node along an arc with capacity left, so a node can always
+           reach the sink (or target) in no fewer steps than its
+           height. Heights of count or more mean the node cannot reach
+           it at all.
+
+           run pushes excess toward the target from the highest active
+           node first, with two heuristics:
+
+           * Gap: when no node is left at some height, those above it
+           are cut off from the target, and lifted to count at once.
+
+           * Global relabel: every so often, the heights are set to
+           the exact distances, by breadth first search back from the
+           target.
+        **/
+
+        template<class N, class W>
+        class push_relabel {
+        public:
+            using node_type = N;
+            using weight_type = W;
+
+            class arc {
+            public:
+                node_type head;
+                weight_type residual;
+                size_t reverse;
+            };
+
+            node_type count;
+            vector<size_t> first;
+            vector<arc> arcs;
+            vector<weight_type> excess;
+            vector<node_type> height;
+
+            template<class G>
+            push_relabel(const G& g, vector<size_t>& edge_arcs);
+
+            // push every excess from nodes other than from and to
+            // toward to, over arcs that do not touch from
+            void run(node_type from, node_type to);
+
+            // send all that an arc can carry, from the node it leaves
+            void saturate(node_type n, size_t a);
+
+        private:
+            static const node_type none = numeric_limits<node_type>::max();
+
+            vector<size_t> current;
+            vector<vector<node_type> > active;
+            vector<node_type> level_first;
+            vector<node_type> level_next;
+            vector<node_type> level_prev;
+            node_type highest_active{0};
+            node_type highest_level{0};
+            size_t work{0};
+
+            void link(node_type n);
+            void unlink(node_type n);
+            void activate(node_type n);
+            void global_relabel(node_type from, node_type to);
+            void discharge(node_type n, node_type from, node_type to);
+            void gap(node_type h);
+        };
+
+        template<class N, class W>
+        const N push_relabel<N,W>::none;
+
+        template<class N, class W>
+        template<class G>
+        push_relabel<N,W>::push_relabel(const G& g, vector<size_t>& edge_arcs) :
+            count{g.node_count()}, first(g.node_count() + 1, 0)
+        {
+            for (auto& e : g) {
+                if (e.source() == e.target()) continue;
+                ++first[e.source() + 1];
+                ++first[e.target() + 1];
+            }
+            for (node_type n = 0; n < count; n++) first[n + 1] += first[n];
+            arcs.resize(first[count]);
+            vector<size_t> next(first.begin(), first.end() - 1);
+            for (auto& e : g) {
+                if (e.source() == e.target()) {
+                    edge_arcs.push_back(numeric_limits<size_t>::max());
+                    continue;
+                }
+                size_t forward = next[e.source()]++;
+                size_t back = next[e.target()]++;
+                arcs[forward] = arc{e.target(), e.weight(), back};
+                arcs[back] = arc{e.source(), 0, forward};
+                edge_arcs.push_back(forward);
+            }
+            excess.assign(count, 0);
+            height.assign(count, count);
+            current.assign(first.begin(), first.end() - 1);
+            active.resize(count);
+            level_first.assign(count, none);
+            level_next.assign(count, none);
+            level_prev.assign(count, none);
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::saturate(node_type n, size_t a)
+        {
+            arc& forward = arcs[a];
+            excess[forward.head] += forward.residual;
+            excess[n] -= forward.residual;
+            arcs[forward.reverse].residual += forward.residual;
+            forward.residual = 0;
+        }
+
+        // the nodes at each height below count are kept in lists, for
+        // the gap heuristic
+        template<class N, class W>
+        void push_relabel<N,W>::link(node_type n)
+        {
+            node_type h = height[n];
+            level_prev[n] = none;
+            level_next[n] = level_first[h];
+            if (level_first[h] != none) level_prev[level_first[h]] = n;
+            level_first[h] = n;
+            highest_level = max(highest_level, h);
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::unlink(node_type n)
+        {
+            if (level_prev[n] != none) level_next[level_prev[n]] = level_next[n];
+            else level_first[height[n]] = level_next[n];
+            if (level_next[n] != none) level_prev[level_next[n]] = level_prev[n];
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::activate(node_type n)
+        {
+            active[height[n]].push_back(n);
+            highest_active = max(highest_active, height[n]);
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::global_relabel(node_type from, node_type to)
+        {
+            for (auto& a : active) a.clear();
+            fill(level_first.begin(), level_first.end(), none);
+            fill(height.begin(), height.end(), count);
+            highest_active = 0;
+            highest_level = 0;
+            height[to] = 0;
+            vector<node_type> queue{to};
+            for (size_t i = 0; i < queue.size(); i++) {
+                node_type n = queue[i];
+                for (size_t a = first[n]; a < first[n + 1]; a++) {
+                    node_type m = arcs[a].head;
+                    if (m == from || height[m] != count || arcs[arcs[a].reverse].residual <= 0) continue;
+                    height[m] = height[n] + 1;
+                    queue.push_back(m);
+                }
+            }
+            for (node_type n : queue) {
+                if (n == to) continue;
+                link(n);
+                current[n] = first[n];
+                if (excess[n] > 0) activate(n);
+            }
+            work = 0;
+        }
+
+        // no node is left at height h, so none above can reach the
+        // target
+        template<class N, class W>
+        void push_relabel<N,W>::gap(node_type h)
+        {
+            for (node_type level = h + 1; level <= highest_level; level++) {
+                for (node_type n = level_first[level]; n != none; n = level_next[n]) height[n] = count;
+                level_first[level] = none;
+                active[level].clear();
+            }
+            highest_level = h > 0 ? h - 1 : 0;
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::discharge(node_type n, node_type from, node_type to)
+        {
+            while (excess[n] > 0) {
+                node_type h = height[n];
+                for (size_t& a = current[n]; a < first[n + 1]; a++) {
+                    arc& forward = arcs[a];
+                    if (forward.residual <= 0 || height[forward.head] + 1 != h) continue;
+                    node_type m = forward.head;
+                    weight_type delta = min(excess[n], forward.residual);
+                    forward.residual -= delta;
+                    arcs[forward.reverse].residual += delta;
+                    if (excess[m] <= 0 && m != to && m != from) activate(m);
+                    excess[m] += delta;
+                    excess[n] -= delta;
+                    if (excess[n] <= 0) return;
+                }
+
+                // relabel, to just above the lowest node n can push to
+                node_type lowest = count;
+                for (size_t a = first[n]; a < first[n + 1]; a++) {
+                    if (arcs[a].residual > 0) lowest = min(lowest, height[arcs[a].head]);
+                }
+                work += first[n + 1] - first[n] + 12;
+                unlink(n);
+                if (level_first[h] == none) {
+                    height[n] = count;
+                    gap(h);
+                    return;
+                }
+                if (lowest + 1 >= count) {
+                    height[n] = count;
+                    return;
+                }
+                height[n] = lowest + 1;
+                link(n);
+                current[n] = first[n];
+            }
+        }
+
+        template<class N, class W>
+        void push_relabel<N,W>::run(node_type from, node_type to)
+        {
+            const size_t relabel_every = 6 * size_t{count} + arcs.size() / 2;
+            global_relabel(from, to);
+            for (;;) {
+                while (highest_active > 0 && active[highest_active].empty()) --highest_active;
+                if (active[highest_active].empty()) return;
+                node_type n = active[highest_active].back();
+                active[highest_active].pop_back();
+                // stale entries, left behind by a gap or a relabel
+                if (height[n] != highest_active || excess[n] <= 0) continue;
+                discharge(n, from, to);
+                if (excess[n] > 0 && height[n] < count) activate(n);
+                if (work > relabel_every) global_relabel(from, to);
+            }
+        }
+    }
+
+    /**
+       max_flow - the greatest flow from source to sink, and a
+       minimum cut
+
+       Each edge's weight() is its capacity; weights must not be
+       negative. Self loops carry nothing.
+
+       This is the push-relabel method of Goldberg and Tarjan, taking
+       the highest active node first, with the gap and global relabel
+       heuristics, after Cherkassky and Goldberg. It works in two
+       phases:
+
+       1. Push as much as can reach the sink. The sink's excess is
+       then the maximum flow, and the minimum cut is known.
+
+       2. Return the excess stranded at other nodes to the source,
+       so what is left is a flow.
+
+       It runs in O(n^2 sqrt(m)) time, and is usually far faster.
+    **/
+
+    template<class G>
+    flow_result<G> max_flow(const G& g,
+                            typename G::node_type source,
+                            typename G::node_type sink)
+    {
+        trace::span traced{"max_flow"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+
+        if (source >= g.node_count() || sink >= g.node_count()) throw out_of_range{"max_flow, no such node"};
+        if (source == sink) throw invalid_argument{"max_flow, source is the sink"};
+
+        vector<size_t> edge_arcs;
+        flow_support::push_relabel<node_type, weight_type> work(g, edge_arcs);
+        for (size_t a = work.first[source]; a < work.first[source + 1]; a++) {
+            if (work.arcs[a].residual > 0) work.saturate(source, a);
+        }
+        work.run(source, sink);
+        work.run(sink, source);
+
+        flow_result<G> result;
+        result.value = work.excess[sink];
+
+        // the source side: what the source can still reach
+        const node_type count = g.node_count();
+        result.source_side.assign(count, false);
+        result.source_side[source] = true;
+        vector<node_type> queue{source};
+        for (size_t i = 0; i < queue.size(); i++) {
+            node_type n = queue[i];
+            for (size_t a = work.first[n]; a < work.first[n + 1]; a++) {
+                node_type m = work.arcs[a].head;
+                if (work.arcs[a].residual <= 0 || result.source_side[m]) continue;
+                result.source_side[m] = true;
+                queue.push_back(m);
+            }
+        }
+
+        result.flows.reserve(g.edge_count());
+        size_t i = 0;
+        for (auto e : g) {
+            if (result.source_side[e.source()] && !result.source_side[e.target()]) result.cut.push_back(e);
+            size_t a = edge_arcs[i++];
+            e.weight() = a == numeric_limits<size_t>::max() ? 0 : e.weight() - work.arcs[a].residual;
+            result.flows.push_back(e);
+        }
+        return result;
+    }
+
+}
+
+#endif
+
+// end of file
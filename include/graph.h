@@ -12,6 +12,9 @@
 #include<limits>
 #include<functional>
 
+#include "trace.h"
+#include "memory.h"
+
 using namespace std;
 
 
@@ -23,8 +26,11 @@ namespace graph {
     class edge_position_hash {
     public:
         size_t operator()(pair<N,N> p) const {
+            // mix the halves; a plain xor sends {i,i+1} edges to a
+            // handful of buckets
             hash<N> h;
-            return h(p.first) ^ h(p.second);
+            size_t seed = h(p.first);
+            return seed ^ (h(p.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
         }
     };
 
@@ -69,7 +75,11 @@ namespace graph {
         {
             for (auto e : es) operator+=(e);
         }
-        graph(const graph& g) : edges(1) { for (auto e : g) operator+=(e); }
+        graph(const graph& g) : edges(1)
+        {
+            trace::span traced{"graph copy"};
+            for (auto e : g) operator+=(e);
+        }
         graph(graph&& g) noexcept : edges(1) { swap(edges, g.edges); swap(locations, g.locations); }
 
         graph& operator=(const graph& g);
@@ -86,11 +96,19 @@ namespace graph {
         const_graph_iterator<graph<E> > end() const { return const_graph_iterator<graph<E> >{*this}; }
         
         graph& operator+=(edge_type edge);
+
+        // add the edges in [first, last), a forward range, growing the
+        // node and lookup tables once rather than edge by edge
+        template<class I> void insert(I first, I last);
         
         bool contains_edge(location_type l) const { return locations.count(l) > 0; }
         void delete_edge(location_type l);
         edge_type& edge_at(location_type l) { return *(locations[l]); }
-        edge_type edge_at(location_type l) const { return *(locations[l]); }
+        edge_type edge_at(location_type l) const { return *(locations.at(l)); }
+
+        // bytes held by the node table, the adjacency lists, and the
+        // edge index with its buckets (see memory.h)
+        memory::report memory_usage() const;
         
     private:
         vector<list_type> edges;
@@ -100,6 +118,7 @@ namespace graph {
     template<class E>
     graph<E>& graph<E>::operator=(const graph<E>& g)
     {
+        trace::span traced{"graph copy"};
         edges.clear();
         locations.clear();
         for (auto e: g) operator+=(e);
@@ -118,6 +137,44 @@ namespace graph {
         return *this;
     }
 
+    template<class E>
+    template<class I>
+    void graph<E>::insert(I first, I last)
+    {
+        trace::span traced{"graph insert"};
+        node_type max_vertex = 0;
+        size_type count = 0;
+        for (I i = first; i != last; ++i, ++count) {
+            max_vertex = max(max_vertex, max(i->source(), i->target()));
+        }
+        if (count == 0) return;
+        if (max_vertex >= edges.size()) {
+            edges.resize(max_vertex+1);
+        }
+        // grow geometrically, so that many small ranges do not each
+        // rehash the whole table
+        size_type needed = locations.size() + count;
+        if (needed > locations.bucket_count() * locations.max_load_factor()) {
+            locations.reserve(max(needed, 2 * locations.size()));
+        }
+        for (I i = first; i != last; ++i) {
+            edges[i->source()].push_front(*i);
+            locations.insert(make_pair(make_pair(i->source(),i->target()), edges[i->source()].begin()));
+        }
+    }
+
+
+    template<class E>
+    memory::report graph<E>::memory_usage() const
+    {
+        using namespace memory::memory_support;
+        memory::report result;
+        result.add("node table", edges.capacity() * sizeof(list_type));
+        result.add("adjacency", locations.size() * list_node_bytes<edge_type>());
+        result.add("index", locations.size() * hash_node_bytes<typename lookup_type::value_type>());
+        result.add("index buckets", hash_bucket_bytes(locations));
+        return result;
+    }
 
     template<class E>
     void graph<E>::delete_edge(location_type l)
@@ -140,6 +197,7 @@ namespace graph {
     template<class G>
     G reverse(const G& g)
     {
+        trace::span traced{"reverse"};
         using edge_type = typename G::edge_type;
         G result;
         for (edge_type e : g) {
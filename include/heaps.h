@@ -10,6 +10,10 @@
 #include <utility>
 #include <limits>
 #include <algorithm>
+#include <type_traits>
+
+#include "stats.h"
+#include "memory.h"
 
 using namespace std;
 
@@ -92,7 +96,8 @@ namespace graph {
             dial_heap(size_type, size_type max_weight) :
                 buckets{vector<bucket_type>(max_weight + 1)},
                 base{0},
-                count{0} { }
+                count{0},
+                rebase_count{0} { }
             
             location_type insert(key_type k, value_type t);
             void decrease_key(location_type loc, key_type old_k, key_type new_k);
@@ -101,16 +106,44 @@ namespace graph {
             void delete_min(); // must follow call to find_min();
             size_type size() const { return count; }
             bool empty() const { return count == 0; }
+
+            // empty the heap, with keys starting from zero again, so
+            // it can serve another search
+            void clear();
+
+            // how many times find_min moved the base past empty buckets
+            unsigned long rebases() const { return rebase_count; }
+
+            // bytes held by the buckets and the entries in them
+            memory::report memory_usage() const;
             
         private:
             vector<bucket_type> buckets;
-            bucket_index_type base;
+            key_type base;
             size_type count;
+            unsigned long rebase_count;
             
             bucket_index_type get_index(key_type k) { return k % buckets.size(); }
             void rebase();
         };
         
+        template<class K, class T>
+        memory::report dial_heap<K,T>::memory_usage() const
+        {
+            memory::report result;
+            result.add("buckets", buckets.capacity() * sizeof(bucket_type));
+            result.add("entries", count * memory::memory_support::list_node_bytes<value_type>());
+            return result;
+        }
+
+        template<class K, class T>
+        void dial_heap<K,T>::clear()
+        {
+            if (count > 0) for (auto& b : buckets) b.clear();
+            base = 0;
+            count = 0;
+        }
+
         template<class K, class T>
         typename dial_heap<K,T>::location_type
         dial_heap<K,T>::insert(key_type k, value_type t)
@@ -141,7 +174,8 @@ namespace graph {
             for(key_type c = 0; c < buckets.size(); c++) {
                 bucket_index_type i = get_index(base + c);
                 if (!buckets[i].empty()) {
-                    base = i;
+                    if (c > 0) ++rebase_count;
+                    base += c;
                     return;
                 }
             }
@@ -152,13 +186,13 @@ namespace graph {
         typename dial_heap<K,T>::value_type dial_heap<K,T>::find_min()
         {
             rebase();
-            return buckets[base].front();
+            return buckets[get_index(base)].front();
         }
         
         template<class K, class T>
         void dial_heap<K,T>::delete_min()
         {
-            buckets[base].pop_front();
+            buckets[get_index(base)].pop_front();
             count -= 1;
         }
         
@@ -188,12 +222,24 @@ namespace graph {
             void delete_min(); // must follow call to find_min();
             size_type size() const { return count; }
             bool empty() const { return count == 0; }
+
+            // empty the heap, with keys starting from zero again, so
+            // it can serve another search
+            void clear();
+
+            // how many times find_min reshuffled a bucket
+            unsigned long redistributions() const { return redistribution_count; }
+
+            // bytes held by the buckets, their ranges and the entries
+            memory::report memory_usage() const;
             
         private:
             
             vector<bucket_type> buckets;
             vector<key_type> ranges;
             size_type count;
+            size_type limit;
+            unsigned long redistribution_count;
             
             bucket_index_type find_bucket(key_type e);
             void new_ranges(key_type start, key_type end);
@@ -202,9 +248,9 @@ namespace graph {
         
         template<class K, class T>
         radix_heap<K,T>::radix_heap(size_type nodes, size_type max_weight) :
-            buckets{}, ranges{}, count{0}
+            buckets{}, ranges{}, count{0}, limit{nodes * max_weight}, redistribution_count{0}
         {
-            size_type size = nodes * max_weight;
+            size_type size = limit;
             size_type depth = 2;
             size_type t_size = size;
             while (t_size >>= 1) ++depth;
@@ -214,6 +260,24 @@ namespace graph {
             count = 0;
         }
         
+        template<class K, class T>
+        void radix_heap<K,T>::clear()
+        {
+            if (count > 0) for (auto& b : buckets) b.clear();
+            new_ranges(0, limit);
+            count = 0;
+        }
+
+        template<class K, class T>
+        memory::report radix_heap<K,T>::memory_usage() const
+        {
+            memory::report result;
+            result.add("buckets", buckets.capacity() * sizeof(bucket_type));
+            result.add("ranges", ranges.capacity() * sizeof(key_type));
+            result.add("entries", count * memory::memory_support::list_node_bytes<elem>());
+            return result;
+        }
+
         template<class K, class T>
         typename radix_heap<K,T>::bucket_index_type
         radix_heap<K,T>::find_bucket(key_type e)
@@ -287,6 +351,7 @@ namespace graph {
             bucket_index_type f = first_occupied();
             if (f >= 2) {
                 // reshuffle elements to get minimum up front
+                ++redistribution_count;
                 bucket_type remove;
                 swap(remove, buckets[f]);
                 key_type min = numeric_limits<key_type>::max();
@@ -310,6 +375,19 @@ namespace graph {
             buckets[f].pop_front();
             count -= 1;
         }
+
+        // for stats::count_stats
+        template<class K, class T>
+        void heap_events(const dial_heap<K,T>& h, stats::counters& c)
+        {
+            c.heap_rebases += h.rebases();
+        }
+
+        template<class K, class T>
+        void heap_events(const radix_heap<K,T>& h, stats::counters& c)
+        {
+            c.heap_redistributions += h.redistributions();
+        }
         
     }
 
@@ -359,6 +437,16 @@ namespace graph {
         size_type size() const { return count; }
         bool empty() const { return count == 0; }
 
+        // empty the heap, so it can serve another search
+        void clear()
+        {
+            root.clear();
+            count = 0;
+        }
+
+        // bytes held by the entries, each a list node
+        memory::report memory_usage() const;
+
     private:
         list_type root;
         size_type count{0};
@@ -367,6 +455,14 @@ namespace graph {
         void merge_root();
     };
 
+    template<class K, class V>
+    memory::report pairing_heap<K,V>::memory_usage() const
+    {
+        memory::report result;
+        result.add("entries", static_cast<size_t>(count) * memory::memory_support::list_node_bytes<element_type>());
+        return result;
+    }
+
     template<class K, class V>
     void pairing_heap<K,V>::link(location_type first, location_type second)
     {
@@ -435,11 +531,23 @@ namespace graph {
     void pairing_heap<K,V>::delete_min()
     {
         if (root.size() != 1) throw out_of_range{"Can't delete_min"};
-        swap(root,root.front().c);
+        list_type children;
+        swap(children, root.front().c);
+        swap(root, children);
         count -= 1;
-        for_each(root.begin(), root.end(), [](element_type e) { e.p = nullptr; });
+        for (auto& e : root) e.p = nullptr;
         merge_root();
     }
+
+    /**
+       default_heap - a dial_heap for integral keys, and a pairing_heap
+       for the rest, which the integral heaps cannot hold
+    **/
+
+    template<class K, class V>
+    using default_heap = typename conditional<is_integral<K>::value,
+                                              heaps::dial_heap<K,V>,
+                                              pairing_heap<K,V> >::type;
     
 }
 
@@ -0,0 +1,306 @@
+// Accounting for the memory the graphs and algorithms use
+// by Veronica Straszheim
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+using namespace std;
+
+namespace graph {
+
+    namespace memory {
+
+        /**
+           MEMORY REPORTS
+
+           graph<E> and the heaps have a memory_usage() that returns a
+           report: the bytes held by each of their parts, by name. The
+           figures are worked out from sizes and counts, not measured,
+           so they are cheap to get. They count what the containers
+           ask their allocator for; what malloc adds on top of that is
+           not counted.
+
+           To measure rather than estimate, see the tracker below.
+        **/
+
+        class report {
+        public:
+            vector<pair<string, size_t> > parts;
+
+            void add(const string& name, size_t bytes);
+            size_t total() const;
+
+            // the bytes of the named part, or zero
+            size_t operator[](const string& name) const;
+
+            report& operator+=(const report& r);
+        };
+
+        inline void report::add(const string& name, size_t bytes)
+        {
+            for (auto& p : parts) {
+                if (p.first == name) {
+                    p.second += bytes;
+                    return;
+                }
+            }
+            parts.push_back(make_pair(name, bytes));
+        }
+
+        inline size_t report::total() const
+        {
+            size_t result = 0;
+            for (auto& p : parts) result += p.second;
+            return result;
+        }
+
+        inline size_t report::operator[](const string& name) const
+        {
+            for (auto& p : parts) if (p.first == name) return p.second;
+            return 0;
+        }
+
+        inline report& report::operator+=(const report& r)
+        {
+            for (auto& p : r.parts) add(p.first, p.second);
+            return *this;
+        }
+
+        inline ostream& operator<<(ostream& os, const report& r)
+        {
+            for (auto& p : r.parts) os << p.first << '\t' << p.second << '\n';
+            return os << "total\t" << r.total() << '\n';
+        }
+
+        namespace memory_support {
+
+            inline size_t round_up(size_t bytes, size_t alignment)
+            {
+                return (bytes + alignment - 1) / alignment * alignment;
+            }
+
+            // a node of words pointers or hashes, and a T
+            template<class T>
+            size_t node_bytes(size_t words)
+            {
+                size_t alignment = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+                return round_up(round_up(words * sizeof(void*), alignof(T)) + sizeof(T), alignment);
+            }
+
+            // a std::list node: two links and the value
+            template<class T>
+            size_t list_node_bytes() { return node_bytes<T>(2); }
+
+            // an unordered_map node: a link, the cached hash and the
+            // value (both standard libraries cache the hash of a
+            // hasher of your own)
+            template<class T>
+            size_t hash_node_bytes() { return node_bytes<T>(2); }
+
+            // the bucket array of an unordered container
+            template<class M>
+            size_t hash_bucket_bytes(const M& m)
+            {
+                return m.bucket_count() * sizeof(void*);
+            }
+        }
+
+        /**
+           TRACKER
+
+           The tracker counts bytes allocated and freed, keeping the
+           current total and its peak. Two things feed it:
+
+           * counting_allocator, for containers of your own.
+
+           * Every new and delete in the program, when one source file
+           defines GRAPH_TRACK_ALLOCATIONS before including this
+           header. That is the way to see an algorithm's workspaces,
+           which are allocated inside it. Each allocation then carries
+           a small header recording its size.
+
+           Use one or the other: a counting_allocator gets its memory
+           from malloc, so it is not counted twice.
+        **/
+
+        class tracker {
+        public:
+            void allocated(size_t bytes);
+            void freed(size_t bytes) { now.fetch_sub(bytes, memory_order_relaxed); }
+
+            size_t current() const { return now.load(memory_order_relaxed); }
+            size_t peak() const { return high.load(memory_order_relaxed); }
+
+            // start the peak again from the current total
+            void reset_peak() { high.store(current(), memory_order_relaxed); }
+
+            // make the peak at least p
+            void raise_peak(size_t p);
+
+        private:
+            atomic<size_t> now{0};
+            atomic<size_t> high{0};
+        };
+
+        inline void tracker::allocated(size_t bytes)
+        {
+            raise_peak(now.fetch_add(bytes, memory_order_relaxed) + bytes);
+        }
+
+        inline void tracker::raise_peak(size_t p)
+        {
+            size_t old = high.load(memory_order_relaxed);
+            while (old < p && !high.compare_exchange_weak(old, p, memory_order_relaxed)) { }
+        }
+
+        inline tracker& global_tracker()
+        {
+            static tracker t;
+            return t;
+        }
+
+        /**
+           watch - the peak memory used over a scope
+
+           {
+               memory::watch w;
+               dijkstra<G, heaps::dial_heap>(g, 0);
+               cout << w.peak() << '\n';
+           }
+
+           peak() is the most allocated at once, beyond what was
+           allocated when the watch started. Watches may nest; the
+           tracker's own peak is kept across them.
+        **/
+
+        class watch {
+        public:
+            watch(tracker& t_ = global_tracker()) :
+                t(t_), start{t_.current()}, outer_peak{t_.peak()}
+            {
+                t.reset_peak();
+            }
+
+            ~watch() { t.raise_peak(outer_peak); }
+
+            size_t peak() const { return t.peak() > start ? t.peak() - start : 0; }
+
+            watch(const watch&) = delete;
+            watch& operator=(const watch&) = delete;
+
+        private:
+            tracker& t;
+            size_t start;
+            size_t outer_peak;
+        };
+
+        /**
+           counting_allocator - a standard allocator that tells a tracker
+
+           list<E, memory::counting_allocator<E> > l;
+        **/
+
+        template<class T>
+        class counting_allocator {
+        public:
+            using value_type = T;
+
+            counting_allocator(tracker& t_ = global_tracker()) : t(&t_) { }
+
+            template<class U>
+            counting_allocator(const counting_allocator<U>& a) : t(a.t) { }
+
+            T* allocate(size_t n)
+            {
+                void* p = malloc(n * sizeof(T));
+                if (!p) throw bad_alloc{};
+                t->allocated(n * sizeof(T));
+                return static_cast<T*>(p);
+            }
+
+            void deallocate(T* p, size_t n)
+            {
+                free(p);
+                t->freed(n * sizeof(T));
+            }
+
+            template<class U> friend class counting_allocator;
+
+            template<class U>
+            bool operator==(const counting_allocator<U>& a) const { return t == a.t; }
+            template<class U>
+            bool operator!=(const counting_allocator<U>& a) const { return t != a.t; }
+
+        private:
+            tracker* t;
+        };
+
+        namespace memory_support {
+
+            // room for the size, keeping the alignment malloc gives
+            const size_t header_bytes = alignof(max_align_t) < sizeof(size_t) ? sizeof(size_t) : alignof(max_align_t);
+
+            inline void* tracked_allocate(size_t bytes)
+            {
+                char* p = static_cast<char*>(malloc(bytes + header_bytes));
+                if (!p) return nullptr;
+                *reinterpret_cast<size_t*>(p) = bytes;
+                global_tracker().allocated(bytes);
+                return p + header_bytes;
+            }
+
+            inline void tracked_free(void* q)
+            {
+                if (!q) return;
+                char* p = static_cast<char*>(q) - header_bytes;
+                global_tracker().freed(*reinterpret_cast<size_t*>(p));
+                free(p);
+            }
+
+            inline void* tracked_new(size_t bytes)
+            {
+                for (;;) {
+                    void* p = tracked_allocate(bytes == 0 ? 1 : bytes);
+                    if (p) return p;
+                    new_handler h = get_new_handler();
+                    if (!h) throw bad_alloc{};
+                    h();
+                }
+            }
+        }
+
+    }
+
+}
+
+#ifdef GRAPH_TRACK_ALLOCATIONS
+
+void* operator new(size_t bytes) { return graph::memory::memory_support::tracked_new(bytes); }
+void* operator new[](size_t bytes) { return graph::memory::memory_support::tracked_new(bytes); }
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+    try { return graph::memory::memory_support::tracked_new(bytes); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
+{
+    try { return graph::memory::memory_support::tracked_new(bytes); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { graph::memory::memory_support::tracked_free(p); }
+void operator delete[](void* p) noexcept { graph::memory::memory_support::tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { graph::memory::memory_support::tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { graph::memory::memory_support::tracked_free(p); }
+
+#endif
+
+#endif
+
+// end of file
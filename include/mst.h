@@ -0,0 +1,341 @@
+// Minimum spanning trees and forests
+// by Veronica Straszheim
+
+#ifndef MST_H
+#define MST_H
+
+#include <vector>
+#include <limits>
+#include <atomic>
+#include <algorithm>
+
+#include "heaps.h"
+#include "parallel.h"
+#include "components.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       MINIMUM SPANNING FORESTS
+
+       These treat a graph of weighted edges as undirected: an edge
+       s -> t joins s and t both ways, and an edge stored in both
+       directions is simply two edges between the same nodes. Self
+       loops are ignored.
+
+       Each returns a spanning_forest: the edges chosen, as stored in
+       the graph, and their total weight. Where the graph is not
+       connected, the forest holds a tree for each of its components.
+       Every algorithm finds a forest of the same, least, weight;
+       where weights tie, the forests may differ.
+
+       * prim - grows each tree from a node with a heap, as dijkstra.
+
+       * kruskal - sorts the edges in parallel, then adds them
+       lightest first, skipping those that would close a cycle.
+
+       * boruvka - in rounds, each tree picks its lightest edge out,
+       in parallel, until no tree has one. Best for large graphs on
+       many threads.
+    **/
+
+    template<class E>
+    class spanning_forest {
+    public:
+        using edge_type = E;
+        using weight_type = typename E::weight_type;
+
+        vector<edge_type> edges;
+        weight_type weight{0};
+    };
+
+    namespace mst_support {
+
+        const size_t token_edge = numeric_limits<size_t>::max();
+
+        // the edges of g, less self loops
+        template<class G>
+        vector<typename G::edge_type> edge_list(const G& g)
+        {
+            vector<typename G::edge_type> result;
+            result.reserve(g.edge_count());
+            for (auto& e : g) if (e.source() != e.target()) result.push_back(e);
+            return result;
+        }
+
+        // is edge i lighter than edge j? Ties go to the lower index,
+        // so no two edges weigh the same
+        template<class E>
+        bool lighter(const vector<E>& edges, size_t i, size_t j)
+        {
+            if (edges[i].weight() != edges[j].weight()) return edges[i].weight() < edges[j].weight();
+            return i < j;
+        }
+
+        /**
+           undirected_index - each node's edges, both ways, by index
+           into an edge list
+
+           The edges at n are arcs[offsets[n]] up to arcs[offsets[n+1]],
+           each the node at the other end and the edge's index.
+        **/
+
+        template<class N>
+        class undirected_index {
+        public:
+            vector<size_t> offsets;
+            vector<pair<N, size_t> > arcs;
+
+            template<class E>
+            undirected_index(N count, const vector<E>& edges);
+        };
+
+        template<class N>
+        template<class E>
+        undirected_index<N>::undirected_index(N count, const vector<E>& edges) :
+            offsets(count + 1, 0), arcs(2 * edges.size())
+        {
+            for (auto& e : edges) {
+                ++offsets[e.source() + 1];
+                ++offsets[e.target() + 1];
+            }
+            for (N n = 0; n < count; n++) offsets[n + 1] += offsets[n];
+            vector<size_t> next(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < edges.size(); i++) {
+                arcs[next[edges[i].source()]++] = make_pair(edges[i].target(), i);
+                arcs[next[edges[i].target()]++] = make_pair(edges[i].source(), i);
+            }
+        }
+
+        // a plain union-find forest, by size, halving paths
+        template<class N>
+        class disjoint_sets {
+        public:
+            disjoint_sets(N count) : parent(count), size(count, 1)
+            {
+                for (N n = 0; n < count; n++) parent[n] = n;
+            }
+
+            N find(N n)
+            {
+                while (parent[n] != n) {
+                    parent[n] = parent[parent[n]];
+                    n = parent[n];
+                }
+                return n;
+            }
+
+            // false if a and b were already joined
+            bool unite(N a, N b)
+            {
+                a = find(a);
+                b = find(b);
+                if (a == b) return false;
+                if (size[a] < size[b]) swap(a, b);
+                parent[b] = a;
+                size[a] += size[b];
+                return true;
+            }
+
+        private:
+            vector<N> parent;
+            vector<N> size;
+        };
+    }
+
+    /**
+       prim - Prim's minimum spanning forest
+
+       H is a heap from heaps.h, as for dijkstra. Prim's keys are
+       edge weights, which do not grow steadily as Dijkstra's path
+       costs do, so the integral heaps, which rely on that, do not
+       fit; the default pairing_heap does.
+    **/
+
+    template<class G, template<class,class> class H = pairing_heap>
+    spanning_forest<typename G::edge_type> prim(const G& g)
+    {
+        trace::span traced{"prim"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+        using mst_support::token_edge;
+
+        const node_type count = g.node_count();
+        vector<edge_type> edges = mst_support::edge_list(g);
+        mst_support::undirected_index<node_type> index(count, edges);
+        weight_type max_weight = 0;
+        for (auto& e : edges) max_weight = max(max_weight, e.weight());
+
+        spanning_forest<edge_type> result;
+        H<weight_type, node_type> heap(count, max_weight);
+        vector<typename decltype(heap)::location_type> locations(count);
+        vector<size_t> best(count, token_edge);
+        vector<bool> queued(count, false);
+        vector<bool> done(count, false);
+
+        for (node_type root = 0; root < count; root++) {
+            if (queued[root]) continue;
+            queued[root] = true;
+            locations[root] = heap.insert(0, root);
+            while (!heap.empty()) {
+                node_type n = heap.find_min();
+                heap.delete_min();
+                done[n] = true;
+                if (best[n] != token_edge) {
+                    result.edges.push_back(edges[best[n]]);
+                    result.weight += edges[best[n]].weight();
+                }
+                for (size_t a = index.offsets[n]; a < index.offsets[n + 1]; a++) {
+                    node_type m = index.arcs[a].first;
+                    size_t i = index.arcs[a].second;
+                    if (done[m]) continue;
+                    if (!queued[m]) {
+                        queued[m] = true;
+                        best[m] = i;
+                        locations[m] = heap.insert(edges[i].weight(), m);
+                    } else if (edges[i].weight() < edges[best[m]].weight()) {
+                        heap.decrease_key(locations[m], edges[best[m]].weight(), edges[i].weight());
+                        best[m] = i;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+       kruskal - Kruskal's minimum spanning forest
+
+       The sort, which is most of the work, is spread over threads;
+       the union-find pass after it is serial.
+    **/
+
+    template<class G>
+    spanning_forest<typename G::edge_type> kruskal(const G& g,
+                                                   unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"kruskal"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+
+        vector<edge_type> edges = mst_support::edge_list(g);
+        parallel::parallel_sort(edges.begin(), edges.end(), [](const edge_type& a, const edge_type& b) {
+                return a.weight() < b.weight();
+            }, threads);
+
+        spanning_forest<edge_type> result;
+        mst_support::disjoint_sets<node_type> sets(g.node_count());
+        for (auto& e : edges) {
+            if (!sets.unite(e.source(), e.target())) continue;
+            result.edges.push_back(e);
+            result.weight += e.weight();
+            if (result.edges.size() + 1 == g.node_count()) break;
+        }
+        return result;
+    }
+
+    /**
+       boruvka - Borůvka's minimum spanning forest, in parallel
+
+       Each round, every edge still joining two trees offers itself
+       to both, and each tree keeps the lightest offer, by an atomic
+       compare and swap. Those edges are added, and the trees they
+       join are merged in a shared union-find forest (see
+       connected_components). Edges now inside one tree are dropped.
+       The number of trees at least halves each round.
+
+       Ties in weight are broken by the edge's place in the graph, so
+       the edges picked in a round can never form a cycle.
+    **/
+
+    template<class G>
+    spanning_forest<typename G::edge_type> boruvka(const G& g,
+                                                   unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"boruvka"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using mst_support::token_edge;
+        using components_support::find_root;
+        threads = max(threads, 1u);
+
+        const node_type count = g.node_count();
+        vector<edge_type> edges = mst_support::edge_list(g);
+
+        vector<atomic<node_type> > parent(count);
+        vector<atomic<size_t> > best(count);
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                parent[n].store(static_cast<node_type>(n), memory_order_relaxed);
+            });
+        parallel::atomic_bitmap taken(edges.size());
+
+        // offer edge i to the tree rooted at r
+        auto offer = [&](node_type r, size_t i) {
+            size_t current = best[r].load(memory_order_relaxed);
+            while (current == token_edge || mst_support::lighter(edges, i, current)) {
+                if (best[r].compare_exchange_weak(current, i, memory_order_relaxed)) return;
+            }
+        };
+
+        spanning_forest<edge_type> result;
+        vector<size_t> live(edges.size());
+        for (size_t i = 0; i < live.size(); i++) live[i] = i;
+        vector<vector<size_t> > parts(threads);
+        while (!live.empty()) {
+            parallel::parallel_for(0, count, threads, [&](size_t n) {
+                    best[n].store(token_edge, memory_order_relaxed);
+                });
+            parallel::parallel_for(0, live.size(), threads, [&](size_t k) {
+                    size_t i = live[k];
+                    node_type a = find_root(parent, edges[i].source());
+                    node_type b = find_root(parent, edges[i].target());
+                    if (a == b) return;
+                    offer(a, i);
+                    offer(b, i);
+                });
+
+            // the chosen edges, each once, in order of tree
+            parallel::parallel_do(threads, [&](unsigned int t) {
+                    parts[t].clear();
+                    for (size_t n = count * size_t{t} / threads; n < count * (size_t{t} + 1) / threads; n++) {
+                        size_t i = best[n].load(memory_order_relaxed);
+                        if (i != token_edge && taken.set(i)) parts[t].push_back(i);
+                    }
+                });
+            vector<size_t> chosen;
+            for (auto& part : parts) chosen.insert(chosen.end(), part.begin(), part.end());
+            if (chosen.empty()) break;
+            parallel::parallel_for(0, chosen.size(), threads, [&](size_t k) {
+                    const edge_type& e = edges[chosen[k]];
+                    components_support::unite(parent, e.source(), e.target());
+                });
+            for (size_t i : chosen) {
+                result.edges.push_back(edges[i]);
+                result.weight += edges[i].weight();
+            }
+
+            // keep the edges still between trees
+            parallel::parallel_do(threads, [&](unsigned int t) {
+                    parts[t].clear();
+                    for (size_t k = live.size() * t / threads; k < live.size() * (t + 1) / threads; k++) {
+                        size_t i = live[k];
+                        if (find_root(parent, edges[i].source()) != find_root(parent, edges[i].target())) {
+                            parts[t].push_back(i);
+                        }
+                    }
+                });
+            live.clear();
+            for (auto& part : parts) live.insert(live.end(), part.begin(), part.end());
+        }
+        return result;
+    }
+
+}
+
+#endif
+
+// end of file
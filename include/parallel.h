@@ -0,0 +1,259 @@
+// Small helpers for the parallel algorithms
+// by Veronica Straszheim
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    namespace parallel {
+
+        /**
+           default_threads - the number of threads to use when the
+           caller does not say. Never less than one.
+        **/
+
+        inline unsigned int default_threads()
+        {
+            unsigned int n = thread::hardware_concurrency();
+            return n == 0 ? 1 : n;
+        }
+
+        /**
+           team_size - how many of threads to use on n items handed
+           out chunk_size at a time: no more than there are chunks,
+           and never less than one.
+
+           Starting a thread costs far more than most chunks of work,
+           so a loop that runs round by round (a level of a search, a
+           round of trimming) should size each round's team this way.
+           A round of one chunk or less then starts no threads at all.
+        **/
+
+        inline unsigned int team_size(size_t n, unsigned int threads, size_t chunk_size)
+        {
+            size_t chunks = (n + chunk_size - 1) / chunk_size;
+            return static_cast<unsigned int>(max<size_t>(1, min<size_t>(threads, chunks)));
+        }
+
+        /**
+           parallel_for - run f(i) for each i in [begin, end)
+
+           Work is handed out in chunks of chunk_size from a shared
+           counter, so uneven iterations balance themselves. The
+           calling thread takes part in the work. With threads set to
+           one, no threads are started at all.
+
+           When tracing, each thread started records a span named
+           after the caller's innermost one.
+
+           f must not throw.
+        **/
+
+        template<class F>
+        void parallel_for(size_t begin,
+                          size_t end,
+                          unsigned int threads,
+                          F f,
+                          size_t chunk_size = 1024)
+        {
+            if (begin >= end) return;
+            threads = team_size(end - begin, threads, chunk_size);
+            if (threads <= 1) {
+                for (size_t i = begin; i < end; ++i) f(i);
+                return;
+            }
+            atomic<size_t> next{begin};
+            auto work = [&]() {
+                for (;;) {
+                    size_t b = next.fetch_add(chunk_size);
+                    if (b >= end) return;
+                    size_t e = min(end, b + chunk_size);
+                    for (size_t i = b; i < e; ++i) f(i);
+                }
+            };
+            const char* name = trace::current();
+            vector<thread> team;
+            for (unsigned int t = 1; t < threads; ++t) {
+                team.emplace_back([&work, name]() {
+                        trace::span traced{name};
+                        work();
+                    });
+            }
+            work();
+            for (auto& t : team) t.join();
+        }
+
+        /**
+           parallel_do - run f(t) once for each thread id t in [0, threads)
+
+           Use this when each thread needs its own workspace. Threads
+           are traced as for parallel_for.
+        **/
+
+        template<class F>
+        void parallel_do(unsigned int threads, F f)
+        {
+            if (threads <= 1) {
+                f(0u);
+                return;
+            }
+            const char* name = trace::current();
+            vector<thread> team;
+            for (unsigned int t = 1; t < threads; ++t) {
+                team.emplace_back([f, name](unsigned int id) mutable {
+                        trace::span traced{name};
+                        f(id);
+                    }, t);
+            }
+            f(0u);
+            for (auto& t : team) t.join();
+        }
+
+        /**
+           parallel_sort - sort [first, last) by less, using many threads
+
+           The range is cut into one run per thread, the runs are
+           sorted at once, and then neighbouring runs are merged in
+           rounds, each round's merges also at once. Small ranges are
+           just sorted. Not stable.
+        **/
+
+        template<class I, class C>
+        void parallel_sort(I first, I last, C less, unsigned int threads)
+        {
+            size_t n = static_cast<size_t>(last - first);
+            if (threads <= 1 || n < 8192) {
+                sort(first, last, less);
+                return;
+            }
+            vector<size_t> bounds(threads + 1);
+            for (unsigned int t = 0; t <= threads; t++) bounds[t] = n * t / threads;
+            parallel_do(threads, [&](unsigned int t) {
+                    sort(first + bounds[t], first + bounds[t + 1], less);
+                });
+            for (size_t width = 1; width < threads; width *= 2) {
+                unsigned int merges = static_cast<unsigned int>((threads + 2 * width - 1) / (2 * width));
+                parallel_do(merges, [&](unsigned int m) {
+                        size_t lo = 2 * width * m;
+                        size_t mid = min<size_t>(lo + width, threads);
+                        size_t hi = min<size_t>(lo + 2 * width, threads);
+                        if (mid < hi) inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], less);
+                    });
+            }
+        }
+
+        /**
+           atomic_min - lower a to v, if v is smaller
+
+           Returns true if this call changed the value.
+        **/
+
+        template<class T>
+        bool atomic_min(atomic<T>& a, T v)
+        {
+            T old = a.load(memory_order_relaxed);
+            while (v < old) {
+                if (a.compare_exchange_weak(old, v, memory_order_relaxed)) return true;
+            }
+            return false;
+        }
+
+        /**
+           ATOMIC BITMAP
+        **/
+
+        /**
+           A fixed size set of bits, safe to set from many threads at
+           once. Used for frontiers and visited sets, where a
+           vector<bool> cannot be shared.
+        **/
+
+        class atomic_bitmap {
+        public:
+            using word_type = uint64_t;
+            using size_type = size_t;
+
+            atomic_bitmap(size_type n) : bits{n}, words((n + 63) / 64) { clear(); }
+
+            size_type size() const { return bits; }
+
+            // sets bit i, returns true if it was not already set
+            bool set(size_type i)
+            {
+                word_type mask = word_type{1} << (i % 64);
+                if (words[i / 64].load(memory_order_relaxed) & mask) return false;
+                return !(words[i / 64].fetch_or(mask, memory_order_relaxed) & mask);
+            }
+
+            bool test(size_type i) const
+            {
+                return (words[i / 64].load(memory_order_relaxed) >> (i % 64)) & 1;
+            }
+
+            void reset(size_type i)
+            {
+                words[i / 64].fetch_and(~(word_type{1} << (i % 64)), memory_order_relaxed);
+            }
+
+            void clear() { for (auto& w : words) w.store(0, memory_order_relaxed); }
+
+            bool empty() const
+            {
+                for (auto& w : words) if (w.load(memory_order_relaxed)) return false;
+                return true;
+            }
+
+            size_type count() const
+            {
+                size_type c = 0;
+                for (auto& w : words) c += popcount(w.load(memory_order_relaxed));
+                return c;
+            }
+
+            // the word holding bits [64*w, 64*w+64), for fast scans
+            size_type word_count() const { return words.size(); }
+            word_type word(size_type w) const { return words[w].load(memory_order_relaxed); }
+
+            void swap(atomic_bitmap& o) { std::swap(bits, o.bits); words.swap(o.words); }
+
+            static size_type popcount(word_type w) { return __builtin_popcountll(w); }
+
+        private:
+            size_type bits;
+            vector<atomic<word_type> > words;
+        };
+
+        /**
+           for_each_set - call f(i) for each bit set in b, in parallel
+           over words of the bitmap
+        **/
+
+        template<class F>
+        void for_each_set(const atomic_bitmap& b, unsigned int threads, F f)
+        {
+            parallel_for(0, b.word_count(), threads, [&](size_t w) {
+                    atomic_bitmap::word_type bits = b.word(w);
+                    while (bits) {
+                        f(w * 64 + __builtin_ctzll(bits));
+                        bits &= bits - 1;
+                    }
+                }, 64);
+        }
+    }
+
+}
+
+#endif
+
+// end of file
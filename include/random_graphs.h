@@ -6,6 +6,15 @@
 
 #include <random>
 #include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <limits>
+
+#include "parallel.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -15,6 +24,22 @@ namespace graph {
        RANDOM DENSE-ISH GRAPHS
     **/
 
+    namespace random_support {
+
+        // a double uniform in [0, 1), the same on every platform
+        inline double uniform(mt19937_64& engine)
+        {
+            return (engine() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        // the engine for block b of a generator run from seed
+        inline mt19937_64 block_engine(unsigned int seed, unsigned int block)
+        {
+            seed_seq sequence{seed, block};
+            return mt19937_64(sequence);
+        }
+    }
+
     /**
        rnd-epsilon-dense - random epsilon-dense graph
 
@@ -26,23 +51,60 @@ namespace graph {
 
        R edge_generator is a funciton that takes two arguments, s and
        t, and returns a new edge.
+
+       Rather than a coin toss for each of the node_count squared
+       pairs, this draws the gap to the next edge from a geometric
+       distribution (Batagelj and Brandes), so the work is in
+       proportion to the edges made.
+
+       The rows are split into one block per thread, each with its
+       own random stream, seeded from seed and the block. The edges
+       are made in order of block, with edge_generator called from
+       the calling thread only, and added in bulk. So for a given
+       seed and thread count the graph is always the same.
      **/
 
     template<class G, class R>
     G rnd_epsilon_dense(typename G::node_type node_count,
                         double probability,
                         R edge_generator,
-                        unsigned int seed = 5675)
+                        unsigned int seed = 5675,
+                        unsigned int threads = 1)
     {
-        default_random_engine generator(seed);
-        bernoulli_distribution distrub(probability);
+        trace::span traced{"rnd_epsilon_dense"};
+        using node_type = typename G::node_type;
+        using location_type = pair<node_type, node_type>;
         G result;
-        for(int s = 0; s < node_count; ++s) {
-            for(int t = 0; t < node_count; ++t) {
-                if (distrub(generator)) {
-                    result += edge_generator(s,t);
+        if (node_count == 0 || probability <= 0) return result;
+
+        threads = max(threads, 1u);
+        const double log_q = probability < 1 ? log(1.0 - probability) : 0;
+        vector<vector<location_type> > blocks(threads);
+        parallel::parallel_do(threads, [&](unsigned int b) {
+                mt19937_64 engine = random_support::block_engine(seed, b);
+                const uint64_t n = node_count;
+                const uint64_t first = n * (n * b / threads);
+                const uint64_t last = n * (n * (b + 1) / threads);
+                // pairs are numbered s * n + t, and k is one past the last
+                uint64_t k = first;
+                for (;;) {
+                    if (probability < 1) {
+                        double skip = floor(log(1.0 - random_support::uniform(engine)) / log_q);
+                        if (skip >= static_cast<double>(last - k)) break;
+                        k += static_cast<uint64_t>(skip);
+                    }
+                    if (k >= last) break;
+                    blocks[b].push_back(location_type{static_cast<node_type>(k / n), static_cast<node_type>(k % n)});
+                    ++k;
                 }
-            }
+            });
+
+        for (auto& block : blocks) {
+            vector<typename G::edge_type> edges;
+            edges.reserve(block.size());
+            for (auto& l : block) edges.push_back(edge_generator(l.first, l.second));
+            vector<location_type>().swap(block);
+            result.insert(edges.begin(), edges.end());
         }
         return result;
     }
@@ -52,6 +114,155 @@ namespace graph {
        RANDOM SPARSE-ISH GRAPHS
     **/
 
+    namespace random_support {
+
+        // splitmix64, to hash a node into its own random bits
+        inline uint64_t mix(uint64_t x)
+        {
+            x += 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        inline double unit(uint64_t bits)
+        {
+            return (bits >> 11) * (1.0 / 9007199254740992.0);
+        }
+    }
+
+    /**
+       rnd_spatial - random graph of nearby nodes, with coordinates
+
+       The nodes sit on a height_width by height_width grid, node
+       i * height_width + j in cell (i, j), placed at a random point
+       inside its cell. An edge joins two nodes whose cells are d
+       apart (the larger of the row and column distances, d > 0) with
+       probability
+
+           base_probability / (4 * slope * d * d)
+
+       capped at one. There are 8d cells at distance d, so each node
+       expects about 2 * base_probability / (slope * d) edges from
+       distance d: many short edges and a few long ones, as roads.
+
+       Rather than look at every pair, the distances are taken in
+       bands [d0, 2 d0). Within a band, candidates are drawn with the
+       band's largest probability, skipping ahead by geometric gaps
+       over the cells of the band, and kept with the ratio of their
+       own probability to that. Each band then costs a constant
+       expected number of draws, so a node costs the log of the grid
+       size plus its edges.
+
+       edge_generator takes s, t and the straight line distance
+       between the two nodes, and returns a new edge. Weights no less
+       than that distance keep it a lower bound on path costs, as
+       goal directed searches need.
+
+       If coordinates is given, it is filled with the position of
+       each node.
+
+       Threads and seeding are as for rnd_epsilon_dense: the nodes
+       are split into one block per thread, each with its own stream,
+       and for a given seed and thread count the graph is always the
+       same. The positions depend on the seed alone.
+     **/
+
+    template<class G, class R>
+    G rnd_spatial(typename G::node_type height_width,
+                  double base_probability,
+                  double slope,
+                  R edge_generator,
+                  unsigned int seed = 4343,
+                  unsigned int threads = 1,
+                  vector<pair<double, double> >* coordinates = nullptr)
+    {
+        trace::span traced{"rnd_spatial"};
+        using node_type = typename G::node_type;
+        using found_type = tuple<node_type, node_type, double>;
+        G result;
+        if (height_width == 0) return result;
+
+        threads = max(threads, 1u);
+        const uint64_t w = height_width;
+        const uint64_t count = w * w;
+
+        vector<pair<double, double> > place(count);
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                uint64_t h = random_support::mix((uint64_t{seed} << 32) ^ n);
+                place[n] = make_pair(n / w + random_support::unit(h),
+                                     n % w + random_support::unit(random_support::mix(h)));
+            });
+        auto distance = [&](uint64_t a, uint64_t b) {
+            return hypot(place[a].first - place[b].first, place[a].second - place[b].second);
+        };
+        auto probability = [&](uint64_t d) {
+            return min(1.0, base_probability / (4.0 * slope * d * d));
+        };
+
+        vector<vector<found_type> > blocks(threads);
+        parallel::parallel_do(threads, [&](unsigned int b) {
+                mt19937_64 engine = random_support::block_engine(seed, b);
+                for (uint64_t n = count * b / threads; n < count * (b + 1) / threads; n++) {
+                    const int64_t i = n / w;
+                    const int64_t j = n % w;
+                    for (uint64_t d0 = 1; d0 < w; d0 *= 2) {
+                        const uint64_t d1 = min(2 * d0, w);
+                        const double top = probability(d0);
+                        if (!(top > 0)) break;
+                        const double log_q = top < 1 ? log(1.0 - top) : 0;
+                        // rings d0 up to d1 hold 4((d1-1)d1 - (d0-1)d0) cells;
+                        // before ring d come 4((d-1)d - (d0-1)d0) of them
+                        const uint64_t before = (d0 - 1) * d0;
+                        const uint64_t cells = 4 * ((d1 - 1) * d1 - before);
+                        for (uint64_t x = 0;; x++) {
+                            if (top < 1) {
+                                double skip = floor(log(1.0 - random_support::uniform(engine)) / log_q);
+                                if (skip >= static_cast<double>(cells - x)) break;
+                                x += static_cast<uint64_t>(skip);
+                            }
+                            if (x >= cells) break;
+
+                            // which ring, and where on it
+                            uint64_t d = static_cast<uint64_t>((1 + sqrt(1.0 + x + 4.0 * before)) / 2);
+                            d = min(max(d, d0), d1 - 1);
+                            while (d > d0 && 4 * ((d - 1) * d - before) > x) d--;
+                            while (d + 1 < d1 && 4 * (d * (d + 1) - before) <= x) d++;
+                            const uint64_t position = x - 4 * ((d - 1) * d - before);
+                            const int64_t side = position / (2 * d);
+                            const int64_t offset = position % (2 * d);
+                            const int64_t r = d;
+                            int64_t di = 0, dj = 0;
+                            switch (side) {
+                            case 0: di = -r; dj = offset - r; break;
+                            case 1: di = offset - r; dj = r; break;
+                            case 2: di = r; dj = r - offset; break;
+                            default: di = r - offset; dj = -r; break;
+                            }
+                            const int64_t k = i + di;
+                            const int64_t l = j + dj;
+                            if (k < 0 || l < 0 || k >= static_cast<int64_t>(w) || l >= static_cast<int64_t>(w)) continue;
+
+                            const double p = probability(d);
+                            if (p < top && random_support::uniform(engine) * top >= p) continue;
+                            const uint64_t m = k * w + l;
+                            blocks[b].push_back(found_type{static_cast<node_type>(n), static_cast<node_type>(m), distance(n, m)});
+                        }
+                    }
+                }
+            });
+
+        for (auto& block : blocks) {
+            vector<typename G::edge_type> edges;
+            edges.reserve(block.size());
+            for (auto& f : block) edges.push_back(edge_generator(get<0>(f), get<1>(f), get<2>(f)));
+            vector<found_type>().swap(block);
+            result.insert(edges.begin(), edges.end());
+        }
+        if (coordinates) coordinates->swap(place);
+        return result;
+    }
+
     /**
        rnd_2d_space - random graph with clustered edges
 
@@ -68,6 +279,8 @@ namespace graph {
 
        edge_generator is a funciton that takes two arguments, s and
        t, and returns a new edge 
+
+       This is rnd_spatial, for callers that do not need distances.
      **/
 
     template<class G, class R>
@@ -75,34 +288,172 @@ namespace graph {
                    double base_probability,
                    double slope,
                    R edge_generator,
-                   unsigned int seed = 4343)
+                   unsigned int seed = 4343,
+                   unsigned int threads = 1)
     {
         using node_type = typename G::node_type;
-        G result;
-        default_random_engine generator(seed);
-        uniform_real_distribution distrub(0,1);
-        for (node_type i = 0; i < height_width; i++) {
-            for (node_type j = 0; j < height_width; j++) {
-                for (node_type k = 0; k < heigth_width; k++) {
-                    for (node_type l = 0; l < height_width; l++) {
-                        node_type dist = max(abs(i-k),abs(j-l));
-                        node_type count = 4 * dist;
-                        double denom = dist * count * slope;
-                        double prob = base_probability / denom;
-                        if (distrub(generator) < prob) {
-                            node_type s = i * height_width + j;
-                            node_type t = k * height_width + l;
-                            result += edge_generator(s,t);
+        auto generator = [&](node_type s, node_type t, double) { return edge_generator(s, t); };
+        return rnd_spatial<G>(height_width, base_probability, slope, generator, seed, threads);
+    }
+
+
+    /**
+       POWER LAW GRAPHS
+    **/
+
+    /**
+       rnd_rmat - recursive matrix (R-MAT) graph, as in Graph500
+
+       Makes edge_factor * 2^scale edges over 2^scale nodes. Each edge
+       is placed by descending scale levels into the adjacency
+       matrix, picking at each level the top left, top right, bottom
+       left or bottom right quarter with probability a, b, c and
+       1 - a - b - c. Uneven quarters give a skewed, power law like
+       degree spread; Graph500 uses a = 0.57, b = 0.19, c = 0.19.
+
+       With permute set, the node labels are shuffled, so that the
+       high degree nodes are not all the low numbered ones.
+
+       Repeated edges are made once; self loops are kept. So there
+       are somewhat fewer edges than asked for.
+
+       edge_generator is a funciton that takes two arguments, s and
+       t, and returns a new edge.
+
+       Threads and seeding are as for rnd_epsilon_dense.
+     **/
+
+    template<class G, class R>
+    G rnd_rmat(unsigned int scale,
+               unsigned int edge_factor,
+               double a,
+               double b,
+               double c,
+               R edge_generator,
+               unsigned int seed = 2718,
+               unsigned int threads = 1,
+               bool permute = true)
+    {
+        trace::span traced{"rnd_rmat"};
+        using node_type = typename G::node_type;
+        using location_type = pair<node_type, node_type>;
+
+        threads = max(threads, 1u);
+        const uint64_t count = uint64_t{1} << scale;
+        const uint64_t edge_count = count * edge_factor;
+
+        vector<node_type> label(count);
+        for (uint64_t n = 0; n < count; n++) label[n] = static_cast<node_type>(n);
+        if (permute) {
+            mt19937_64 engine = random_support::block_engine(seed, numeric_limits<unsigned int>::max());
+            for (uint64_t n = count - 1; n > 0; n--) swap(label[n], label[engine() % (n + 1)]);
+        }
+
+        vector<vector<location_type> > blocks(threads);
+        parallel::parallel_do(threads, [&](unsigned int block) {
+                mt19937_64 engine = random_support::block_engine(seed, block);
+                const uint64_t first = edge_count * block / threads;
+                const uint64_t last = edge_count * (block + 1) / threads;
+                vector<location_type>& out = blocks[block];
+                out.reserve(last - first);
+                for (uint64_t i = first; i < last; i++) {
+                    uint64_t s = 0, t = 0;
+                    for (uint64_t bit = count >> 1; bit; bit >>= 1) {
+                        double r = random_support::uniform(engine);
+                        if (r < a) continue;
+                        if (r < a + b) t |= bit;
+                        else if (r < a + b + c) s |= bit;
+                        else {
+                            s |= bit;
+                            t |= bit;
                         }
                     }
+                    out.push_back(location_type{label[s], label[t]});
                 }
+                sort(out.begin(), out.end());
+                out.erase(unique(out.begin(), out.end()), out.end());
+            });
+
+        // merge the sorted blocks, dropping edges made twice
+        vector<location_type> all;
+        for (auto& block : blocks) {
+            size_t middle = all.size();
+            all.insert(all.end(), block.begin(), block.end());
+            vector<location_type>().swap(block);
+            inplace_merge(all.begin(), all.begin() + middle, all.end());
+            all.erase(unique(all.begin(), all.end()), all.end());
+        }
+
+        G result;
+        vector<typename G::edge_type> edges;
+        edges.reserve(all.size());
+        for (auto& l : all) edges.push_back(edge_generator(l.first, l.second));
+        vector<location_type>().swap(all);
+        result.insert(edges.begin(), edges.end());
+        return result;
+    }
+
+
+    /**
+       rnd_preferential - preferential attachment graph (Barabasi-Albert)
+
+       Adds the nodes in turn, each with edges to edges_per_node of
+       the nodes before it, chosen in proportion to their degree. So
+       early nodes become hubs, with degrees following a power law.
+
+       Degrees are never counted. Following Batagelj and Brandes, all
+       edge ends made so far are kept in one buffer, in which each
+       node appears once per edge it has; a uniform pick from the
+       buffer is a pick by degree. The buffer, two node ids per edge,
+       is the only memory beyond the graph itself. Edges are made in
+       batches and added in bulk as they go.
+
+       Edges run from the new node to the older one. A pick of the
+       new node itself, or of a node already picked, makes no edge,
+       so there are somewhat fewer than node_count * edges_per_node.
+
+       edge_generator is a funciton that takes two arguments, s and
+       t, and returns a new edge.
+     **/
+
+    template<class G, class R>
+    G rnd_preferential(typename G::node_type node_count,
+                       unsigned int edges_per_node,
+                       R edge_generator,
+                       unsigned int seed = 1414)
+    {
+        trace::span traced{"rnd_preferential"};
+        using node_type = typename G::node_type;
+        using edge_type = typename G::edge_type;
+        const size_t batch_size = 1 << 16;
+
+        G result;
+        mt19937_64 engine = random_support::block_engine(seed, 0);
+        vector<node_type> ends(2 * uint64_t{node_count} * edges_per_node);
+        vector<edge_type> batch;
+        batch.reserve(batch_size + edges_per_node);
+        vector<node_type> picked;
+
+        uint64_t k = 0;
+        for (uint64_t v = 0; v < node_count; v++) {
+            picked.clear();
+            for (unsigned int i = 0; i < edges_per_node; i++, k += 2) {
+                ends[k] = static_cast<node_type>(v);
+                node_type t = ends[engine() % (k + 1)];
+                ends[k + 1] = t;
+                if (t == v || find(picked.begin(), picked.end(), t) != picked.end()) continue;
+                picked.push_back(t);
+                batch.push_back(edge_generator(static_cast<node_type>(v), t));
+            }
+            if (batch.size() >= batch_size) {
+                result.insert(batch.begin(), batch.end());
+                batch.clear();
             }
         }
+        result.insert(batch.begin(), batch.end());
         return result;
     }
-                   
-       
-    
+
 }
 
 #endif
@@ -0,0 +1,253 @@
+// Answering many reachability queries on one graph
+// by Veronica Straszheim
+
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+
+#include "edge.h"
+#include "graph.h"
+#include "walks.h"
+#include "parallel.h"
+#include "memory.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace graph {
+
+    /**
+       CONDENSATION
+    **/
+
+    /**
+       condensation - the graph of the components of g
+
+       components is a partition of g into strongly connected
+       components, such as pearce_scc returns. The result has one
+       node per component and one edge for each pair of components
+       joined by some edge of g; it is acyclic.
+
+       The last components may have no edges, and so fall outside
+       node_count() of the result.
+    **/
+
+    template<class G>
+    graph<edge<typename G::node_type> >
+    condensation(const G& g, const component_set<typename G::node_type>& components)
+    {
+        using node_type = typename G::node_type;
+        graph<edge<node_type> > result;
+        for (auto& e : g) {
+            node_type s = components.ids[e.source()];
+            node_type t = components.ids[e.target()];
+            if (s != t && !result.contains_edge({s, t})) result += edge<node_type>{s, t};
+        }
+        return result;
+    }
+
+    /**
+       REACHABILITY INDEX
+    **/
+
+    /**
+       reachability_index - answers "can a reach b?" with a lookup
+
+       The graph is condensed by pearce_scc, whose components come out
+       in reverse topological order: a component can only reach those
+       numbered no higher than itself. Then the transitive closure of
+       the condensation is kept as bitsets, cut into chunks of
+       chunk_bits target components.
+
+       For each chunk, a search back along the condensation's edges
+       from the chunk's components finds the components that can
+       reach into it, and only those are visited. They are filled in
+       in increasing order, each the union of its successors' rows and
+       its own bit. The chunks are independent, so they are built by
+       separate threads, and the unions are plain loops over a few
+       words that the compiler vectorizes.
+
+       A chunk stores rows only for the components that reach some
+       other component in it, sorted, so a query is a binary search
+       within one chunk. The index grows with the closure itself, not
+       with the number of components: a condensation with no edges
+       stores no rows at all. A dense closure still costs about
+       C * C / 8 bytes for C components.
+
+       The index is a snapshot; it does not follow later changes to g.
+    **/
+
+    template<class G>
+    class reachability_index {
+    public:
+        using node_type = typename G::node_type;
+        using word_type = uint64_t;
+        static const size_t chunk_words = 8;
+        static const size_t chunk_bits = 64 * chunk_words;
+
+        reachability_index(const G& g, unsigned int threads = parallel::default_threads());
+
+        // true if there is a path from a to b (always so when a == b)
+        bool reaches(node_type a, node_type b) const;
+        bool operator()(node_type a, node_type b) const { return reaches(a, b); }
+
+        const component_set<node_type>& components() const { return parts; }
+
+        // bytes held by the components, and by the rows of the
+        // closure with their index (see memory.h)
+        memory::report memory_usage() const;
+
+    private:
+        // one chunk of the closure: the row of component from[i] is
+        // words[i * chunk_words], and from is sorted
+        class chunk {
+        public:
+            vector<node_type> from;
+            vector<word_type> words;
+        };
+
+        component_set<node_type> parts;
+        vector<chunk> chunks;
+    };
+
+    template<class G>
+    const size_t reachability_index<G>::chunk_words;
+
+    template<class G>
+    const size_t reachability_index<G>::chunk_bits;
+
+    template<class G>
+    reachability_index<G>::reachability_index(const G& g, unsigned int threads) :
+        parts(pearce_scc(g))
+    {
+        trace::span traced{"reachability_index"};
+        const size_t count = parts.size();
+        const uint32_t no_row = numeric_limits<uint32_t>::max();
+
+        // successors of each component, each list sorted and unique
+        vector<vector<node_type> > successors(count);
+        parallel::parallel_for(0, count, threads, [&](size_t c) {
+                vector<node_type>& out = successors[c];
+                for (auto n = parts.begin(c); n != parts.end(c); ++n) {
+                    for (auto& e : g[*n]) {
+                        node_type d = parts.ids[e.target()];
+                        if (d != c) out.push_back(d);
+                    }
+                }
+                sort(out.begin(), out.end());
+                out.erase(unique(out.begin(), out.end()), out.end());
+            }, 64);
+
+        // and predecessors, flat: those of d are
+        // predecessors[first[d]] up to predecessors[first[d+1]]
+        vector<size_t> first(count + 1, 0);
+        for (size_t c = 0; c < count; c++) for (node_type d : successors[c]) ++first[d + 1];
+        for (size_t d = 0; d < count; d++) first[d + 1] += first[d];
+        vector<node_type> predecessors(first[count]);
+        {
+            vector<size_t> next(first.begin(), first.end() - 1);
+            for (size_t c = 0; c < count; c++) {
+                for (node_type d : successors[c]) predecessors[next[d]++] = static_cast<node_type>(c);
+            }
+        }
+
+        chunks.resize((count + chunk_bits - 1) / chunk_bits);
+        atomic<size_t> next_chunk{0};
+        parallel::parallel_do(parallel::team_size(chunks.size(), threads, 1), [&](unsigned int) {
+                // per thread: which chunk last reached each component,
+                // and the row it has there, if any
+                vector<size_t> visited(count, numeric_limits<size_t>::max());
+                vector<uint32_t> slot(count, no_row);
+                vector<node_type> reached;
+                for (size_t k = next_chunk++; k < chunks.size(); k = next_chunk++) {
+                    chunk& ch = chunks[k];
+                    const size_t lo = k * chunk_bits;
+                    const size_t hi = min(count, lo + chunk_bits);
+
+                    // what reaches into the chunk, in increasing order,
+                    // so that successors come first
+                    reached.clear();
+                    for (size_t c = lo; c < hi; c++) {
+                        visited[c] = k;
+                        reached.push_back(static_cast<node_type>(c));
+                    }
+                    for (size_t i = 0; i < reached.size(); i++) {
+                        node_type d = reached[i];
+                        for (size_t p = first[d]; p < first[d + 1]; p++) {
+                            node_type c = predecessors[p];
+                            if (visited[c] == k) continue;
+                            visited[c] = k;
+                            reached.push_back(c);
+                        }
+                    }
+                    sort(reached.begin(), reached.end());
+
+                    word_type row[chunk_words];
+                    for (node_type c : reached) {
+                        fill(row, row + chunk_words, 0);
+                        bool other = false;
+                        for (auto s = lower_bound(successors[c].begin(), successors[c].end(), lo);
+                             s != successors[c].end(); ++s) {
+                            if (slot[*s] != no_row) {
+                                const word_type* from = &ch.words[slot[*s] * chunk_words];
+                                for (size_t w = 0; w < chunk_words; w++) row[w] |= from[w];
+                                other = true;
+                            } else if (*s < hi) {
+                                row[(*s - lo) / 64] |= word_type{1} << ((*s - lo) % 64);
+                                other = true;
+                            }
+                        }
+                        // a row holding only its own bit is left out
+                        if (!other) continue;
+                        if (c < hi) row[(c - lo) / 64] |= word_type{1} << ((c - lo) % 64);
+                        slot[c] = static_cast<uint32_t>(ch.from.size());
+                        ch.from.push_back(c);
+                        ch.words.insert(ch.words.end(), row, row + chunk_words);
+                    }
+                    for (node_type c : ch.from) slot[c] = no_row;
+                }
+            });
+    }
+
+    template<class G>
+    memory::report reachability_index<G>::memory_usage() const
+    {
+        memory::report result;
+        result.add("components", (parts.ids.capacity() + parts.nodes.capacity()) * sizeof(node_type) +
+                   parts.offsets.capacity() * sizeof(size_t));
+        size_t index = chunks.capacity() * sizeof(chunk);
+        size_t rows = 0;
+        for (auto& ch : chunks) {
+            index += ch.from.capacity() * sizeof(node_type);
+            rows += ch.words.capacity() * sizeof(word_type);
+        }
+        result.add("row index", index);
+        result.add("rows", rows);
+        return result;
+    }
+
+    template<class G>
+    bool reachability_index<G>::reaches(node_type a, node_type b) const
+    {
+        size_t from = parts.ids[a];
+        size_t to = parts.ids[b];
+        if (from == to) return true;
+        if (from < to) return false;
+        const chunk& ch = chunks[to / chunk_bits];
+        auto i = lower_bound(ch.from.begin(), ch.from.end(), static_cast<node_type>(from));
+        if (i == ch.from.end() || *i != from) return false;
+        size_t r = static_cast<size_t>(i - ch.from.begin());
+        size_t bit = to % chunk_bits;
+        return (ch.words[r * chunk_words + bit / 64] >> (bit % 64)) & 1;
+    }
+
+}
+
+#endif
+
+// end of file
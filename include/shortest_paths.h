@@ -9,6 +9,14 @@
 #include <utility>
 #include <queue>
 #include <deque>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+
+#include "heaps.h"
+#include "parallel.h"
+#include "stats.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -38,16 +46,22 @@ namespace graph {
        H is a heap class, as provided in heaps.h.
 
        unreachable nodes are assigned a maximum value for their type.
+
+       stats is a policy from stats.h, told of each node settled, edge
+       scanned and heap operation. Pass a stats::count_stats to see
+       where the time goes.
        
     **/
     
-    template<class G, template<class,class> class H>
+    template<class G, template<class,class> class H, class S>
     pair<vector<typename G::edge_type::weight_type>,
          vector<typename G::node_type> >
     dijkstra(const G& g,
              typename G::node_type source_node,
-             typename G::edge_type::weight_type max_edge_cost)
+             typename G::edge_type::weight_type max_edge_cost,
+             S& stats)
     {
+        trace::span traced{"dijkstra"};
         using edge_type = typename G::edge_type;
         using node_type = typename G::node_type;
         using weight_type = typename edge_type::weight_type;
@@ -63,27 +77,47 @@ namespace graph {
 
         costs[source_node] = 0;
         locations[source_node] = heap.insert(0, source_node);
+        stats.inserted();
 
         while(!heap.empty()) {
             node_type node = heap.find_min();
             heap.delete_min();
+            stats.deleted_min();
+            stats.settled();
             for (auto edge : g[node]) {
+                stats.scanned();
                 weight_type this_cost = costs[node] + edge.weight();
                 if (costs[edge.target()] == numeric_limits<weight_type>::max()) {
                     // new entry
                     costs[edge.target()] = this_cost;
                     parents[edge.target()] = node;
                     locations[edge.target()] = heap.insert(this_cost, edge.target());
+                    stats.relaxed();
+                    stats.inserted();
                 } else if (this_cost < costs[edge.target()]) {
                     // existing entry improved
                     parents[edge.target()] = node;
                     heap.decrease_key(locations[edge.target()], costs[edge.target()], this_cost);
                     costs[edge.target()] = this_cost;
+                    stats.relaxed();
+                    stats.decreased();
                 }
             }
         }
+        stats.heap(heap);
         return make_pair(costs, parents);
     }
+
+    template<class G, template<class,class> class H>
+    pair<vector<typename G::edge_type::weight_type>,
+         vector<typename G::node_type> >
+    dijkstra(const G& g,
+             typename G::node_type source_node,
+             typename G::edge_type::weight_type max_edge_cost)
+    {
+        stats::no_stats none;
+        return dijkstra<G,H>(g, source_node, max_edge_cost, none);
+    }
     
     /**
        dijkstra - Dikstra's shortest path algoritm
@@ -119,6 +153,9 @@ namespace graph {
 
        Note, this algorithm is essentially Bellman-Ford, but with
        better average case performance. It runs in O(n*m) worst case.
+
+       stats is a policy from stats.h, as for dijkstra. A node taken
+       off the queue counts as settled, though it may come back.
      **/
 
     template<class N>
@@ -129,12 +166,14 @@ namespace graph {
         negative_cycle_found(N n, vector<N> p, string s) : logic_error{s}, node{n}, parents{p} {};
     };
     
-    template<class G>
+    template<class G, class S>
     pair<vector<typename G::edge_type::weight_type>,
          vector<typename G::node_type> >
     q_lc(const G& g,
-         typename G::node_type source_node)
+         typename G::node_type source_node,
+         S& stats)
     {
+        trace::span traced{"q_lc"};
         using edge_type = typename G::edge_type;
         using node_type = typename G::node_type;
         using weight_type = typename edge_type::weight_type;
@@ -157,18 +196,22 @@ namespace graph {
             node_type n = q.front();
             q.pop();
             in_q[n] = false;
+            stats.settled();
             if (++counts[n] >= g.node_count()) {
                 throw negative_cycle_found<node_type>{n, parents, "Negative cycle found"};
             }
             for (auto e : g[n]) {
+                stats.scanned();
                 weight_type candidate_cost = costs[n] + e.weight();
                 // if this edge is better, use that
                 if (costs[e.target()] > candidate_cost) {
+                    stats.relaxed();
                     costs[e.target()] = candidate_cost;
                     parents[e.target()] = n;
                     // e.target() has improved; perhaps its children
                     // will improve, so recheck
                     if (!in_q[e.target()]) {
+                        if (counts[e.target()] > 0) stats.reentered();
                         q.push(e.target());
                         in_q[e.target()] = true;
                     }
@@ -178,6 +221,270 @@ namespace graph {
         return make_pair(costs, parents);
     }
 
+    template<class G>
+    pair<vector<typename G::edge_type::weight_type>,
+         vector<typename G::node_type> >
+    q_lc(const G& g,
+         typename G::node_type source_node)
+    {
+        stats::no_stats none;
+        return q_lc(g, source_node, none);
+    }
+
+    /**
+       par_bf - frontier-parallel Bellman-Ford
+
+       Like q_lc this allows negative edge costs, but the work is
+       done in rounds. Each round relaxes the out edges of every node
+       improved in the round before (the frontier), spread across
+       threads. Costs are lowered with an atomic min, and the
+       frontiers are bitmaps rather than a queue.
+
+       After each round the parents of the improved nodes are fixed
+       up from the edges that are tight, so the parents vector agrees
+       with the costs.
+
+       Without negative cycles the frontier empties within
+       node_count() rounds. If it does not, negative_cycle_found is
+       thrown. Its node is on a cycle of the parents vector when one
+       can be found, and following parents from there walks the
+       cycle.
+     **/
+
+    template<class G>
+    pair<vector<typename G::edge_type::weight_type>,
+         vector<typename G::node_type> >
+    par_bf(const G& g,
+           typename G::node_type source_node,
+           unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"par_bf"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+        using parallel::atomic_bitmap;
+        using parallel::for_each_set;
+
+        const weight_type token_cost = numeric_limits<weight_type>::max();
+        const node_type token_node = numeric_limits<node_type>::max();
+
+        vector<atomic<weight_type> > costs(g.node_count());
+        vector<atomic<node_type> > parents(g.node_count());
+        for (node_type n = 0; n < g.node_count(); n++) {
+            costs[n].store(token_cost, memory_order_relaxed);
+            parents[n].store(token_node, memory_order_relaxed);
+        }
+
+        // the nodes to relax this round, and those improved by it
+        atomic_bitmap frontier(g.node_count());
+        atomic_bitmap next(g.node_count());
+
+        costs[source_node].store(0, memory_order_relaxed);
+        frontier.set(source_node);
+
+        for (node_type round = 0; !frontier.empty(); ++round) {
+            if (round >= g.node_count()) {
+                vector<node_type> p(g.node_count());
+                for (node_type n = 0; n < g.node_count(); n++) p[n] = parents[n].load();
+                // step back far enough to be sure we are on the cycle
+                node_type n = 0;
+                while (!frontier.test(n)) ++n;
+                for (node_type i = 0; i < g.node_count() && p[n] != token_node; i++) n = p[n];
+                throw negative_cycle_found<node_type>{n, p, "Negative cycle found"};
+            }
+            for_each_set(frontier, threads, [&](size_t n) {
+                    weight_type cost = costs[n].load(memory_order_relaxed);
+                    for (auto& e : g[n]) {
+                        if (parallel::atomic_min(costs[e.target()],
+                                                static_cast<weight_type>(cost + e.weight()))) {
+                            next.set(e.target());
+                        }
+                    }
+                });
+            // the improved nodes take their parent from a tight edge
+            for_each_set(frontier, threads, [&](size_t n) {
+                    weight_type cost = costs[n].load(memory_order_relaxed);
+                    for (auto& e : g[n]) {
+                        if (next.test(e.target()) &&
+                            cost + e.weight() == costs[e.target()].load(memory_order_relaxed)) {
+                            parents[e.target()].store(n, memory_order_relaxed);
+                        }
+                    }
+                });
+            frontier.swap(next);
+            next.clear();
+        }
+
+        vector<weight_type> result_costs(g.node_count());
+        vector<node_type> result_parents(g.node_count());
+        for (node_type n = 0; n < g.node_count(); n++) {
+            result_costs[n] = costs[n].load();
+            result_parents[n] = parents[n].load();
+        }
+        return make_pair(result_costs, result_parents);
+    }
+
+    /**
+       tarjan_lc - label correcting with subtree disassembly
+
+       This keeps the current shortest path tree threaded in
+       preorder. When a node's label improves, its subtree is taken
+       apart: every descendant has a stale label, so it is dropped
+       from the tree and, if queued, will not be scanned until its
+       label improves again. If the node that caused the improvement
+       is itself among the descendants, the tree has closed a
+       negative cycle, which is found the moment it forms rather than
+       after node_count() passes.
+
+       The queue discipline is chosen by policy:
+
+       * fifo - plain first in, first out
+
+       * slf - small label first; a node is queued at the front if
+       its label is below the front node's, otherwise at the back
+
+       * lll - large label last; a front node whose label is above
+       the queue average is rotated to the back before scanning
+
+       * slf_lll - both
+
+       On a negative cycle this throws negative_cycle_path, which
+       holds the cycle itself: cycle[0] to cycle[1] and so on, with
+       the last node leading back to cycle[0]. Its parents vector is
+       left empty.
+     **/
+
+    enum class lc_queue { fifo, slf, lll, slf_lll };
+
+    template<class N>
+    class negative_cycle_path : public negative_cycle_found<N> {
+    public:
+        vector<N> cycle;
+        negative_cycle_path(vector<N> c, string s) :
+            negative_cycle_found<N>{c.front(), vector<N>{}, s}, cycle{c} {};
+    };
+
+    template<class G>
+    pair<vector<typename G::edge_type::weight_type>,
+         vector<typename G::node_type> >
+    tarjan_lc(const G& g,
+              typename G::node_type source_node,
+              lc_queue policy = lc_queue::slf_lll)
+    {
+        trace::span traced{"tarjan_lc"};
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using weight_type = typename edge_type::weight_type;
+
+        const node_type token_node = numeric_limits<node_type>::max();
+        const bool slf = policy == lc_queue::slf || policy == lc_queue::slf_lll;
+        const bool lll = policy == lc_queue::lll || policy == lc_queue::slf_lll;
+
+        vector<weight_type> costs(g.node_count(), numeric_limits<weight_type>::max());
+        vector<node_type> parents(g.node_count(), token_node);
+
+        // the tree, as a circular list in preorder, plus depths;
+        // nodes out of the tree have token_node depth
+        vector<node_type> after(g.node_count(), token_node);
+        vector<node_type> before(g.node_count(), token_node);
+        vector<node_type> depth(g.node_count(), token_node);
+
+        // queue state: 0 not queued, 1 queued, 2 queued but disassembled
+        deque<node_type> dq;
+        vector<unsigned char> state(g.node_count(), 0);
+
+        // sum and count of the live labels in the queue, for lll
+        double queued_sum = 0;
+        node_type queued_count = 0;
+
+        auto enqueue = [&](node_type n) {
+            queued_sum += costs[n];
+            ++queued_count;
+            if (state[n] == 2) {
+                // still in the deque, just dormant
+                state[n] = 1;
+                return;
+            }
+            state[n] = 1;
+            if (slf && !dq.empty() && costs[n] < costs[dq.front()]) dq.push_front(n);
+            else dq.push_back(n);
+        };
+
+        costs[source_node] = 0;
+        depth[source_node] = 0;
+        after[source_node] = before[source_node] = source_node;
+        enqueue(source_node);
+
+        while(!dq.empty()) {
+            if (lll) {
+                for (size_t rotations = dq.size(); rotations > 0 && queued_count > 1; --rotations) {
+                    node_type f = dq.front();
+                    dq.pop_front();
+                    if (state[f] == 2) {
+                        state[f] = 0;
+                        continue;
+                    }
+                    if (static_cast<double>(costs[f]) * queued_count <= queued_sum) {
+                        dq.push_front(f);
+                        break;
+                    }
+                    dq.push_back(f);
+                }
+            }
+            node_type n = dq.front();
+            dq.pop_front();
+            if (state[n] == 2) {
+                state[n] = 0;
+                continue;
+            }
+            state[n] = 0;
+            queued_sum -= costs[n];
+            --queued_count;
+            for (auto& e : g[n]) {
+                node_type t = e.target();
+                weight_type candidate_cost = costs[n] + e.weight();
+                if (!(candidate_cost < costs[t])) continue;
+                if (t == n) {
+                    throw negative_cycle_path<node_type>{vector<node_type>{n}, "Negative cycle found"};
+                }
+                if (depth[t] != token_node) {
+                    // take apart the subtree below t
+                    node_type w = after[t];
+                    while (depth[w] > depth[t]) {
+                        if (w == n) {
+                            vector<node_type> cycle;
+                            for (node_type c = n; c != t; c = parents[c]) cycle.push_back(c);
+                            cycle.push_back(t);
+                            std::reverse(cycle.begin(), cycle.end());
+                            throw negative_cycle_path<node_type>{cycle, "Negative cycle found"};
+                        }
+                        if (state[w] == 1) {
+                            state[w] = 2;
+                            queued_sum -= costs[w];
+                            --queued_count;
+                        }
+                        node_type next = after[w];
+                        after[w] = before[w] = depth[w] = token_node;
+                        w = next;
+                    }
+                    after[before[t]] = w;
+                    before[w] = before[t];
+                }
+                if (state[t] == 1) queued_sum += static_cast<double>(candidate_cost) - costs[t];
+                costs[t] = candidate_cost;
+                parents[t] = n;
+                // hang t below n
+                after[t] = after[n];
+                before[after[n]] = t;
+                after[n] = t;
+                before[t] = n;
+                depth[t] = depth[n] + 1;
+                if (state[t] != 1) enqueue(t);
+            }
+        }
+        return make_pair(costs, parents);
+    }
+
     /**
        dq_lc - deque-based label correcting algorithm
 
@@ -191,14 +498,18 @@ namespace graph {
 
        However, note that this algorithm has good average case
        performance on sparse graphs.
+
+       stats is a policy from stats.h, as for q_lc.
      **/
 
-    template<class G>
+    template<class G, class S>
     pair<vector<typename G::edge_type::weight_type>,
          vector<typename G::node_type> >
     dq_lc(const G& g,
-          typename G::node_type source_node)
+          typename G::node_type source_node,
+          S& stats)
     {
+        trace::span traced{"dq_lc"};
         using edge_type = typename G::edge_type;
         using node_type = typename G::node_type;
         using weight_type = typename edge_type::weight_type;
@@ -222,10 +533,13 @@ namespace graph {
             node_type n = dq.front();
             dq.pop_front();
             in_dq[n] = false;
+            stats.settled();
             for (auto e : g[n]) {
+                stats.scanned();
                 weight_type candidate_cost = costs[n] + e.weight();
                 // if this edge is better, use that
                 if (costs[e.target()] > candidate_cost) {
+                    stats.relaxed();
                     costs[e.target()] = candidate_cost;
                     parents[e.target()] = n;
                     // e.target() has improved, so recheck its children
@@ -233,6 +547,7 @@ namespace graph {
                         if (seen[e.target()]) {
                             // nodes we have already seen go up front,
                             // as their children are likely in-queue
+                            stats.reentered();
                             dq.push_front(e.target());
                             in_dq[e.target()] = true;
                         } else {
@@ -248,8 +563,283 @@ namespace graph {
         return make_pair(costs, parents);
     }
 
+    template<class G>
+    pair<vector<typename G::edge_type::weight_type>,
+         vector<typename G::node_type> >
+    dq_lc(const G& g,
+          typename G::node_type source_node)
+    {
+        stats::no_stats none;
+        return dq_lc(g, source_node, none);
+    }
+
+
+    /**
+       UNIT AND 0-1 WEIGHTS
+     **/
+
+    /**
+       edge_weights - what an edge type says about its weights
+
+       weighted is true when E has a weight_type. zero_one is true
+       when that weight_type is bool, so every edge costs 0 or 1.
+       cost_type is the type used to add up a path: the weight type
+       for weighted edges, and node_type (a hop count) otherwise.
+
+       Specialize this for an edge type of your own to change how
+       sssp handles it.
+     **/
+
+    template<class E, class = void>
+    class edge_weights {
+    public:
+        static const bool weighted = false;
+        static const bool zero_one = false;
+        using cost_type = typename E::node_type;
+    };
+
+    template<class E>
+    class edge_weights<E, typename conditional<true, void, typename E::weight_type>::type> {
+    public:
+        static const bool weighted = true;
+        static const bool zero_one = is_same<typename E::weight_type, bool>::value;
+        using cost_type = typename conditional<zero_one,
+                                               typename E::node_type,
+                                               typename E::weight_type>::type;
+    };
+
+    /**
+       bfs_paths - breadth first shortest paths, counting hops
+
+       Returns the same costs and parents as dijkstra, where every
+       edge costs one. Weights, if any, are ignored.
+
+       This version only walks forward (top down), one level at a
+       time.
+     **/
+
+    template<class G>
+    pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+         vector<typename G::node_type> >
+    bfs_paths(const G& g,
+              typename G::node_type source_node)
+    {
+        trace::span traced{"bfs_paths"};
+        using node_type = typename G::node_type;
+        using cost_type = typename edge_weights<typename G::edge_type>::cost_type;
+
+        vector<cost_type> costs(g.node_count(), numeric_limits<cost_type>::max());
+        vector<node_type> parents(g.node_count(), numeric_limits<node_type>::max());
+
+        vector<node_type> frontier{source_node};
+        vector<node_type> next;
+        costs[source_node] = 0;
+        for (cost_type level = 1; !frontier.empty(); ++level) {
+            for (node_type n : frontier) {
+                for (auto& e : g[n]) {
+                    if (costs[e.target()] == numeric_limits<cost_type>::max()) {
+                        costs[e.target()] = level;
+                        parents[e.target()] = n;
+                        next.push_back(e.target());
+                    }
+                }
+            }
+            swap(frontier, next);
+            next.clear();
+        }
+        return make_pair(costs, parents);
+    }
+
+    /**
+       bfs_paths - direction optimizing breadth first shortest paths
+
+       As above, but given r, the reverse of g (see reverse()), this
+       switches between walking forward and walking backward, after
+       Beamer, Asanovic and Patterson.
+
+       Top down, each frontier node scans its out edges. Bottom up,
+       each unvisited node scans its in edges (its out edges in r)
+       until it finds a parent in the frontier, held as a bitmap.
+       Bottom up wins when the frontier is large, since most
+       unvisited nodes find a parent in their first few in edges.
+
+       We go bottom up when the frontier's out edges exceed 1/alpha of
+       the edges still unexplored, and back top down once the
+       frontier shrinks below 1/beta of the nodes.
+     **/
+
+    template<class G>
+    pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+         vector<typename G::node_type> >
+    bfs_paths(const G& g,
+              const G& r,
+              typename G::node_type source_node,
+              unsigned int alpha = 14,
+              unsigned int beta = 24)
+    {
+        trace::span traced{"bfs_paths"};
+        using node_type = typename G::node_type;
+        using cost_type = typename edge_weights<typename G::edge_type>::cost_type;
+        const cost_type token_cost = numeric_limits<cost_type>::max();
+
+        vector<cost_type> costs(g.node_count(), token_cost);
+        vector<node_type> parents(g.node_count(), numeric_limits<node_type>::max());
+
+        vector<node_type> frontier{source_node};
+        vector<node_type> next;
+        vector<bool> in_frontier(g.node_count(), false);
+
+        // out edges of the nodes not yet reached, counted from the
+        // lists, which keep repeated edges that edge_count() does not
+        size_t unexplored = 0;
+        for (node_type n = 0; n < g.node_count(); n++) unexplored += g[n].size();
+        unexplored -= g[source_node].size();
+        bool bottom_up = false;
+
+        costs[source_node] = 0;
+        for (cost_type level = 1; !frontier.empty(); ++level) {
+            size_t frontier_edges = 0;
+            for (node_type n : frontier) frontier_edges += g[n].size();
+            if (!bottom_up && frontier_edges > unexplored / alpha) {
+                bottom_up = true;
+            } else if (bottom_up && frontier.size() < g.node_count() / beta) {
+                bottom_up = false;
+            }
+
+            if (bottom_up) {
+                for (node_type n : frontier) in_frontier[n] = true;
+                for (node_type n = 0; n < g.node_count() && n < r.node_count(); n++) {
+                    if (costs[n] != token_cost) continue;
+                    for (auto& e : r[n]) {
+                        if (in_frontier[e.target()]) {
+                            costs[n] = level;
+                            parents[n] = e.target();
+                            next.push_back(n);
+                            break;
+                        }
+                    }
+                }
+                for (node_type n : frontier) in_frontier[n] = false;
+            } else {
+                for (node_type n : frontier) {
+                    for (auto& e : g[n]) {
+                        if (costs[e.target()] == token_cost) {
+                            costs[e.target()] = level;
+                            parents[e.target()] = n;
+                            next.push_back(e.target());
+                        }
+                    }
+                }
+            }
+            for (node_type n : next) unexplored -= g[n].size();
+            swap(frontier, next);
+            next.clear();
+        }
+        return make_pair(costs, parents);
+    }
+
+    /**
+       zero_one_bfs - shortest paths where every edge costs 0 or 1
+
+       A deque replaces the heap: a node reached over a 0 edge goes
+       to the front, over a 1 edge to the back. The deque then holds
+       at most two distinct costs, front to back, and each node is
+       scanned once, in order of cost. O(n + m).
+
+       Weights outside {0,1} give unspecified results.
+     **/
+
+    template<class G>
+    pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+         vector<typename G::node_type> >
+    zero_one_bfs(const G& g,
+                 typename G::node_type source_node)
+    {
+        trace::span traced{"zero_one_bfs"};
+        using node_type = typename G::node_type;
+        using cost_type = typename edge_weights<typename G::edge_type>::cost_type;
+
+        vector<cost_type> costs(g.node_count(), numeric_limits<cost_type>::max());
+        vector<node_type> parents(g.node_count(), numeric_limits<node_type>::max());
+        vector<bool> done(g.node_count(), false);
+
+        deque<node_type> dq;
+        costs[source_node] = 0;
+        dq.push_back(source_node);
+
+        while (!dq.empty()) {
+            node_type n = dq.front();
+            dq.pop_front();
+            if (done[n]) continue;
+            done[n] = true;
+            for (auto& e : g[n]) {
+                cost_type candidate_cost = costs[n] + (e.weight() ? 1 : 0);
+                if (candidate_cost < costs[e.target()]) {
+                    costs[e.target()] = candidate_cost;
+                    parents[e.target()] = n;
+                    if (candidate_cost == costs[n]) dq.push_front(e.target());
+                    else dq.push_back(e.target());
+                }
+            }
+        }
+        return make_pair(costs, parents);
+    }
+
+    /**
+       sssp - single source shortest paths, picking the algorithm
+
+       The algorithm is chosen at compile time from the edge type
+       (see edge_weights):
+
+       * edges without weights use bfs_paths
+
+       * edges with bool weights use zero_one_bfs
+
+       * anything else uses dijkstra with the heap H
+     **/
+
+    namespace sssp_support {
+
+        template<class E>
+        using algorithm = integral_constant<int,
+                                            !edge_weights<E>::weighted ? 0 :
+                                            edge_weights<E>::zero_one ? 1 : 2>;
+
+        template<template<class,class> class H, class G>
+        pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+             vector<typename G::node_type> >
+        run(const G& g, typename G::node_type source_node, integral_constant<int,0>)
+        {
+            return bfs_paths(g, source_node);
+        }
+
+        template<template<class,class> class H, class G>
+        pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+             vector<typename G::node_type> >
+        run(const G& g, typename G::node_type source_node, integral_constant<int,1>)
+        {
+            return zero_one_bfs(g, source_node);
+        }
+
+        template<template<class,class> class H, class G>
+        pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+             vector<typename G::node_type> >
+        run(const G& g, typename G::node_type source_node, integral_constant<int,2>)
+        {
+            return dijkstra<G,H>(g, source_node);
+        }
+    }
+
+    template<template<class,class> class H = heaps::dial_heap, class G>
+    pair<vector<typename edge_weights<typename G::edge_type>::cost_type>,
+         vector<typename G::node_type> >
+    sssp(const G& g,
+         typename G::node_type source_node)
+    {
+        return sssp_support::run<H>(g, source_node,
+                                    sssp_support::algorithm<typename G::edge_type>{});
+    }
 
-    
 }
 
 #endif
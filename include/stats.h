@@ -0,0 +1,152 @@
+// Counters for what the algorithms do
+// by Veronica Straszheim
+
+#ifndef STATS_H
+#define STATS_H
+
+using namespace std;
+
+namespace graph {
+
+    namespace stats {
+
+        /**
+           STATS POLICIES
+
+           The shortest path algorithms and dfw take a stats policy,
+           which they tell about each step of their work: a node
+           settled, an edge scanned, a heap operation, and so on.
+
+           * no_stats, the default, ignores it all. Its members are
+           empty and inline, so the calls compile away.
+
+           * count_stats adds it up in a counters struct.
+
+           A policy of your own needs the same members as no_stats.
+        **/
+
+        /**
+           counters - what count_stats counts
+
+           nodes_settled: nodes taken off the heap or queue, or
+           entered by a walk
+
+           edges_scanned: edges looked at from a settled node
+
+           relaxations: edges that lowered the cost of their target
+
+           heap_inserts, heap_decrease_keys, heap_delete_mins: calls
+           made on the heap
+
+           heap_rebases: moves of a dial_heap's base past empty buckets
+
+           heap_redistributions: reshuffles of a radix_heap's buckets
+
+           queue_reentries: nodes put back in a label correcting queue
+           after having left it
+
+           for_each calls f(name, value) for each, for writing them out.
+        **/
+
+        class counters {
+        public:
+            unsigned long nodes_settled{0};
+            unsigned long edges_scanned{0};
+            unsigned long relaxations{0};
+            unsigned long heap_inserts{0};
+            unsigned long heap_decrease_keys{0};
+            unsigned long heap_delete_mins{0};
+            unsigned long heap_rebases{0};
+            unsigned long heap_redistributions{0};
+            unsigned long queue_reentries{0};
+
+            void clear() { *this = counters{}; }
+            counters& operator+=(const counters& c);
+
+            template<class F>
+            void for_each(F f) const;
+        };
+
+        inline counters& counters::operator+=(const counters& c)
+        {
+            nodes_settled += c.nodes_settled;
+            edges_scanned += c.edges_scanned;
+            relaxations += c.relaxations;
+            heap_inserts += c.heap_inserts;
+            heap_decrease_keys += c.heap_decrease_keys;
+            heap_delete_mins += c.heap_delete_mins;
+            heap_rebases += c.heap_rebases;
+            heap_redistributions += c.heap_redistributions;
+            queue_reentries += c.queue_reentries;
+            return *this;
+        }
+
+        template<class F>
+        void counters::for_each(F f) const
+        {
+            f("nodes_settled", nodes_settled);
+            f("edges_scanned", edges_scanned);
+            f("relaxations", relaxations);
+            f("heap_inserts", heap_inserts);
+            f("heap_decrease_keys", heap_decrease_keys);
+            f("heap_delete_mins", heap_delete_mins);
+            f("heap_rebases", heap_rebases);
+            f("heap_redistributions", heap_redistributions);
+            f("queue_reentries", queue_reentries);
+        }
+
+        /**
+           heap_events - add up what a heap did on its own
+
+           Heaps that rebase or redistribute overload this (see
+           heaps.h); others have nothing to add.
+        **/
+
+        template<class H>
+        void heap_events(const H&, counters&) { }
+
+        /**
+           no_stats - the policy that does nothing
+        **/
+
+        class no_stats {
+        public:
+            void settled() { }
+            void scanned() { }
+            void relaxed() { }
+            void inserted() { }
+            void decreased() { }
+            void deleted_min() { }
+            void reentered() { }
+            template<class H> void heap(const H&) { }
+        };
+
+        /**
+           count_stats - the policy that counts
+
+           The counts go on growing across runs, until cleared.
+        **/
+
+        class count_stats {
+        public:
+            counters counts;
+
+            void settled() { ++counts.nodes_settled; }
+            void scanned() { ++counts.edges_scanned; }
+            void relaxed() { ++counts.relaxations; }
+            void inserted() { ++counts.heap_inserts; }
+            void decreased() { ++counts.heap_decrease_keys; }
+            void deleted_min() { ++counts.heap_delete_mins; }
+            void reentered() { ++counts.queue_reentries; }
+            template<class H> void heap(const H& h) { heap_events(h, counts); }
+
+            void clear() { counts.clear(); }
+        };
+
+    }
+
+}
+
+#endif
+
+// end of file
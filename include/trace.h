@@ -0,0 +1,325 @@
+// Timing the phases of a run, across threads
+// by Veronica Straszheim
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+
+using namespace std;
+
+namespace graph {
+
+    namespace trace {
+
+        /**
+           TRACING
+
+           A span times a scope: it is opened by its constructor and
+           closed by its destructor, and then recorded, with the thread
+           it ran on. The algorithms open one for each call (dijkstra,
+           top_sort, reverse, and so on), and the parallel helpers open
+           one on each thread they start, named after the span that
+           started it. So a trace shows where the time went, stage by
+           stage and thread by thread.
+
+           Tracing is off until enable() is called. While off, a span
+           costs one relaxed atomic load. Building with GRAPH_NO_TRACE
+           defined takes spans out altogether.
+
+           Each thread records into a ring buffer of its own, holding
+           the last capacity() spans; older ones are dropped. When a
+           thread ends, its ring, with its spans and thread number,
+           passes to the next thread to start, so the threads of one
+           parallel call after another share the same few numbers. Write a
+           trace with write_chrome_json, and open it in Perfetto or
+           chrome://tracing. Do this once the traced work is done:
+           spans still open are not in it.
+
+           Span names and categories are not copied, so they must be
+           string literals, or otherwise outlive the trace.
+        **/
+
+        /**
+           event - a closed span
+
+           Times are in nanoseconds since the first use of tracing.
+        **/
+
+        class event {
+        public:
+            const char* name;
+            const char* category;
+            uint64_t start;
+            uint64_t duration;
+            unsigned int thread;
+        };
+
+        namespace trace_support {
+
+            using clock_type = chrono::steady_clock;
+
+            // the spans of one thread, oldest overwritten first
+            class ring {
+            public:
+                mutex lock;
+                unsigned int thread;
+                vector<event> events;
+                size_t next{0};
+                size_t dropped{0};
+
+                void add(const event& e, size_t capacity);
+            };
+
+            inline void ring::add(const event& e, size_t capacity)
+            {
+                lock_guard<mutex> guard(lock);
+                if (events.size() < capacity) {
+                    events.push_back(e);
+                    return;
+                }
+                if (events.empty()) return;
+                events[next] = e;
+                next = (next + 1) % events.size();
+                ++dropped;
+            }
+
+            // every ring made, and in idle those whose threads have
+            // ended, for new threads to take up
+            class registry {
+            public:
+                mutex lock;
+                vector<shared_ptr<ring> > rings;
+                vector<shared_ptr<ring> > idle;
+                atomic<bool> on{false};
+                atomic<size_t> capacity{1 << 16};
+                clock_type::time_point epoch{clock_type::now()};
+            };
+
+            inline registry& global()
+            {
+                static registry r;
+                return r;
+            }
+
+            // a thread's hold on its ring, which it gives back on exit
+            class holder {
+            public:
+                shared_ptr<ring> mine;
+
+                ~holder();
+            };
+
+            inline holder::~holder()
+            {
+                if (!mine) return;
+                registry& r = global();
+                lock_guard<mutex> guard(r.lock);
+                r.idle.push_back(move(mine));
+            }
+
+            // this thread's ring, on first use taken from a thread that
+            // has ended, with its thread number, or else made new; so
+            // there are only ever as many rings as threads at once
+            inline ring& local()
+            {
+                registry& r = global();
+                thread_local holder h;
+                if (!h.mine) {
+                    lock_guard<mutex> guard(r.lock);
+                    if (!r.idle.empty()) {
+                        h.mine = move(r.idle.back());
+                        r.idle.pop_back();
+                    } else {
+                        h.mine = make_shared<ring>();
+                        h.mine->thread = static_cast<unsigned int>(r.rings.size());
+                        r.rings.push_back(h.mine);
+                    }
+                }
+                return *h.mine;
+            }
+
+            // the innermost open span of this thread
+            inline const char*& current()
+            {
+                thread_local const char* name = nullptr;
+                return name;
+            }
+
+            inline uint64_t now()
+            {
+                return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(clock_type::now() - global().epoch).count());
+            }
+
+            inline void write_string(ostream& os, const char* s)
+            {
+                os << '"';
+                for (; *s; ++s) {
+                    if (*s == '"' || *s == '\\') os << '\\' << *s;
+                    else if (static_cast<unsigned char>(*s) < 0x20) os << ' ';
+                    else os << *s;
+                }
+                os << '"';
+            }
+        }
+
+        inline void enable(bool on = true) { trace_support::global().on.store(on, memory_order_relaxed); }
+        inline void disable() { enable(false); }
+        inline bool enabled() { return trace_support::global().on.load(memory_order_relaxed); }
+
+        // how many spans each thread keeps; set before tracing
+        inline size_t capacity() { return trace_support::global().capacity.load(); }
+        inline void set_capacity(size_t n) { trace_support::global().capacity.store(max(n, size_t{1})); }
+
+        // the name of the innermost span open on this thread, or nullptr
+        inline const char* current() { return trace_support::current(); }
+
+        /**
+           span - times the scope it lives in
+
+           {
+               trace::span s{"load"};
+               ...
+           }
+        **/
+
+#ifdef GRAPH_NO_TRACE
+
+        class span {
+        public:
+            explicit span(const char*, const char* = "graph") { }
+        };
+
+#else
+
+        class span {
+        public:
+            explicit span(const char* name_, const char* category_ = "graph") :
+                name{name_}, category{category_}, outer{nullptr}, start{0}, live{false}
+            {
+                if (!name || !enabled()) return;
+                live = true;
+                outer = trace_support::current();
+                trace_support::current() = name;
+                start = trace_support::now();
+            }
+
+            ~span()
+            {
+                if (!live) return;
+                uint64_t end = trace_support::now();
+                trace_support::ring& r = trace_support::local();
+                r.add(event{name, category, start, end - start, r.thread}, capacity());
+                trace_support::current() = outer;
+            }
+
+            span(const span&) = delete;
+            span& operator=(const span&) = delete;
+
+        private:
+            const char* name;
+            const char* category;
+            const char* outer;
+            uint64_t start;
+            bool live;
+        };
+
+#endif
+
+        /**
+           events - every span recorded, in order of start
+        **/
+
+        inline vector<event> events()
+        {
+            trace_support::registry& r = trace_support::global();
+            vector<event> result;
+            lock_guard<mutex> guard(r.lock);
+            for (auto& ring : r.rings) {
+                lock_guard<mutex> ring_guard(ring->lock);
+                result.insert(result.end(), ring->events.begin(), ring->events.end());
+            }
+            stable_sort(result.begin(), result.end(), [](const event& a, const event& b) {
+                    return a.start < b.start || (a.start == b.start && a.duration > b.duration);
+                });
+            return result;
+        }
+
+        // spans lost to full ring buffers, over all threads
+        inline size_t dropped()
+        {
+            trace_support::registry& r = trace_support::global();
+            size_t result = 0;
+            lock_guard<mutex> guard(r.lock);
+            for (auto& ring : r.rings) {
+                lock_guard<mutex> ring_guard(ring->lock);
+                result += ring->dropped;
+            }
+            return result;
+        }
+
+        // forget what has been recorded
+        inline void clear()
+        {
+            trace_support::registry& r = trace_support::global();
+            lock_guard<mutex> guard(r.lock);
+            for (auto& ring : r.rings) {
+                lock_guard<mutex> ring_guard(ring->lock);
+                ring->events.clear();
+                ring->next = 0;
+                ring->dropped = 0;
+            }
+        }
+
+        /**
+           write_chrome_json - the trace, in the Chrome trace event format
+
+           Each span is a complete ("X") event, with times in
+           microseconds; each thread that recorded anything is named.
+        **/
+
+        inline void write_chrome_json(ostream& os)
+        {
+            vector<event> all = events();
+            vector<unsigned int> threads;
+            for (auto& e : all) threads.push_back(e.thread);
+            sort(threads.begin(), threads.end());
+            threads.erase(unique(threads.begin(), threads.end()), threads.end());
+
+            os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            bool first = true;
+            for (unsigned int t : threads) {
+                os << (first ? "\n" : ",\n");
+                first = false;
+                os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                   << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+            }
+            for (auto& e : all) {
+                os << (first ? "\n" : ",\n");
+                first = false;
+                os << "{\"name\":";
+                trace_support::write_string(os, e.name);
+                os << ",\"cat\":";
+                trace_support::write_string(os, e.category);
+                os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+                   << ",\"ts\":" << e.start / 1000 << '.' << (e.start % 1000) / 100 << (e.start % 100) / 10 << e.start % 10
+                   << ",\"dur\":" << e.duration / 1000 << '.' << (e.duration % 1000) / 100 << (e.duration % 100) / 10 << e.duration % 10
+                   << '}';
+            }
+            os << "\n]}\n";
+        }
+
+    }
+
+}
+
+#endif
+
+// end of file
@@ -7,6 +7,16 @@
 #include <vector>
 #include <functional>
 #include <limits>
+#include <utility>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <atomic>
+#include <algorithm>
+
+#include "parallel.h"
+#include "stats.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -37,9 +47,18 @@ namespace graph {
        the callback functions can set "finished" true, which will halt the walk
        
        set directed false to not explore reverse edges.
+
+       The walk does not recurse. It keeps its own stack of frames,
+       each a node and the next of its edges to look at, so graphs of
+       any depth can be walked. The stack is kept between calls to
+       save reallocating it.
+
+       S is a stats policy, from stats.h. With stats::count_stats,
+       stats.counts holds the nodes entered (as nodes_settled) and the
+       edges scanned, summed over calls.
     **/
     
-    template<class G>
+    template<class G, class S = stats::no_stats>
     class dfw {
     public:
         using edge_type = typename G::edge_type;
@@ -56,6 +75,7 @@ namespace graph {
         function<void(edge_type)> edge{[](edge_type e) {}};
         bool finished{false};
         bool directed{true};
+        S stats;
         
         dfw(const G& g) :
             parents{vector<node_type>(g.node_count(), token_node)},
@@ -77,33 +97,51 @@ namespace graph {
         void operator()(const G& g, node_type n);
         
     private:
+        using frame_type = pair<node_type, typename G::list_type::const_iterator>;
+
         tick_type ticks{0};    
+        vector<frame_type> frames;
     };
     
     // the main walk
-    template<class G>
-    void dfw<G>::operator()(const G& g, node_type n) 
+    template<class G, class S>
+    void dfw<G,S>::operator()(const G& g, node_type n) 
     {
         if (finished) return;
+        frames.clear();
+        stats.settled();
         mark_discovered(n);
         pre(n);
-        for (auto e : g[n]) {
+        frames.push_back(frame_type{n, g[n].begin()});
+        while (!frames.empty()) {
+            node_type current = frames.back().first;
+            if (frames.back().second == g[current].end()) {
+                post(current);
+                mark_processed(current);
+                frames.pop_back();
+                if (!frames.empty() && finished) return;
+                continue;
+            }
+            auto e = *frames.back().second++;
+            stats.scanned();
             if (!discovered(e.target())) {
-                parents[e.target()] = n;
-                edge(e);
-                (*this)(g, e.target());
-            } else if (directed || !processed(e.target())) {
+                parents[e.target()] = current;
                 edge(e);
+                if (finished) return;
+                stats.settled();
+                mark_discovered(e.target());
+                pre(e.target());
+                frames.push_back(frame_type{e.target(), g[e.target()].begin()});
+            } else {
+                if (directed || !processed(e.target())) edge(e);
+                if (finished) return;
             }
-            if (finished) return;
         }
-        post(n);
-        mark_processed(n);
     }
     
     // edge classification
-    template<class G>
-    edge_class dfw<G>::classify_edge(typename G::edge_type e) const
+    template<class G, class S>
+    edge_class dfw<G,S>::classify_edge(typename G::edge_type e) const
     {
         if (parents[e.target()] == e.source()) return edge_class::tree;
         if (discovered(e.target()) && !processed(e.target())) return edge_class::back;
@@ -111,8 +149,264 @@ namespace graph {
         if (processed(e.target()) && entered_before(e.target(), e.source())) return edge_class::cross;
         throw logic_error{"Unclassified edge"};    
     }
+
+
+    /**
+       DEPTH FIRST WALK WITH A STATIC VISITOR
+    **/
+
+    /**
+       static_dfw - depth first walk with callbacks fixed at compile time
+
+       This walks as dfw does, but the callbacks are members of a
+       visitor type V rather than std::function objects, so they are
+       inlined, and hooks left empty cost nothing. Derive visitors
+       from dfw_visitor, which supplies an empty version of each:
+
+       pre(node) and post(node) - pre-order and post-order
+
+       edge(edge, edge_class) - each edge looked at, already
+       classified (the classification is only computed if used)
+
+       finished() - checked after each callback; return true to halt
+
+       The walk state is also smaller than dfw's. A node has a 32 bit
+       entry tick and two flag bits. Parents are not kept, since the
+       path from the root to the current node is just the stack;
+       parents() rebuilds them for the nodes on it.
+    **/
+
+    template<class G>
+    class dfw_visitor {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+
+        void pre(node_type) {}
+        void post(node_type) {}
+        void edge(const edge_type&, edge_class) {}
+        bool finished() const { return false; }
+    };
+
+    template<class G, class V>
+    class static_dfw {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        using tick_type = uint32_t;
+        const node_type token_node = numeric_limits<node_type>::max();
+
+        V& visitor;
+        bool directed{true};
+
+        static_dfw(const G& g, V& v) :
+            visitor(v),
+            entered(g.node_count()),
+            discovered_flags(g.node_count(), false),
+            processed_flags(g.node_count(), false) {};
+
+        bool discovered(node_type n) const { return discovered_flags[n]; }
+        bool processed(node_type n) const { return processed_flags[n]; }
+        bool entered_before(node_type n, node_type m) const { return entered[n] < entered[m]; }
+
+        // parents of the nodes on the current path, token_node elsewhere
+        vector<node_type> parents() const;
+
+        // main operation
+        void operator()(const G& g, node_type n);
+
+    private:
+        using frame_type = pair<node_type, typename G::list_type::const_iterator>;
+
+        vector<tick_type> entered;
+        vector<bool> discovered_flags;
+        vector<bool> processed_flags;
+        tick_type ticks{0};
+        vector<frame_type> frames;
+
+        void enter(node_type n)
+        {
+            entered[n] = ticks++;
+            discovered_flags[n] = true;
+        }
+
+        edge_class classify(node_type s, node_type t) const
+        {
+            if (!processed(t)) return edge_class::back;
+            if (entered_before(s, t)) return edge_class::forward;
+            return edge_class::cross;
+        }
+    };
+
+    template<class G, class V>
+    vector<typename G::node_type> static_dfw<G,V>::parents() const
+    {
+        vector<node_type> result(entered.size(), token_node);
+        for (size_t i = 1; i < frames.size(); i++) result[frames[i].first] = frames[i-1].first;
+        return result;
+    }
+
+    template<class G, class V>
+    void static_dfw<G,V>::operator()(const G& g, node_type n)
+    {
+        if (visitor.finished()) return;
+        frames.clear();
+        enter(n);
+        visitor.pre(n);
+        frames.push_back(frame_type{n, g[n].begin()});
+        while (!frames.empty()) {
+            node_type current = frames.back().first;
+            if (frames.back().second == g[current].end()) {
+                visitor.post(current);
+                processed_flags[current] = true;
+                frames.pop_back();
+                if (!frames.empty() && visitor.finished()) return;
+                continue;
+            }
+            const edge_type& e = *frames.back().second++;
+            node_type t = e.target();
+            if (!discovered(t)) {
+                visitor.edge(e, edge_class::tree);
+                if (visitor.finished()) return;
+                enter(t);
+                visitor.pre(t);
+                frames.push_back(frame_type{t, g[t].begin()});
+            } else {
+                if (directed || !processed(t)) visitor.edge(e, classify(current, t));
+                if (visitor.finished()) return;
+            }
+        }
+    }
     
     
+    /**
+       PARALLEL BREADTH FIRST WALK
+    **/
+
+    /**
+       bfw - breadth first walk, using many threads
+
+       After a walk from one or more sources:
+
+       hops[node] := the number of edges on a shortest path to node
+       parents[node] := the node before it on one such path
+
+       Both hold token_node for nodes not reached. A walk continues
+       from the state left by earlier ones, so calling it again adds
+       to what was found; use a new bfw to start over.
+
+       The walk goes a level at a time. Each level's frontier is cut
+       into chunks, and each thread starts with its own run of them;
+       a thread out of work steals chunks from the others. A node is
+       claimed by whichever thread first sets its bit in a shared
+       atomic bitmap. Each thread gathers its claims in a buffer of
+       its own, and the buffers are copied into the next frontier at
+       offsets summed ahead of time, so no locks are taken.
+
+       The visitor, if given, is called as visit(n, parent, hops)
+       once for each node reached (parent is token_node for the
+       sources). Calls come from many threads at once, so it must be
+       safe for that.
+    **/
+
+    template<class G>
+    class bfw {
+    public:
+        using edge_type = typename G::edge_type;
+        using node_type = typename G::node_type;
+        const node_type token_node = numeric_limits<node_type>::max();
+
+        vector<node_type> parents;
+        vector<node_type> hops;
+        unsigned int threads;
+        size_t chunk_size{256};
+
+        bfw(const G& g, unsigned int t = parallel::default_threads()) :
+            parents(g.node_count(), token_node),
+            hops(g.node_count(), token_node),
+            threads{max(t, 1u)},
+            visited{g.node_count()} {}
+
+        bool reached(node_type n) const { return visited.test(n); }
+
+        void operator()(const G& g, node_type source) { operator()(g, vector<node_type>{source}); }
+        void operator()(const G& g, const vector<node_type>& sources)
+        {
+            operator()(g, sources, [](node_type, node_type, node_type) {});
+        }
+
+        template<class V>
+        void operator()(const G& g, const vector<node_type>& sources, V visit);
+
+    private:
+        // a thread's run of chunks; next is shared with thieves
+        class run_type {
+        public:
+            atomic<size_t> next;
+            size_t end;
+        };
+
+        parallel::atomic_bitmap visited;
+    };
+
+    template<class G>
+    template<class V>
+    void bfw<G>::operator()(const G& g, const vector<node_type>& sources, V visit)
+    {
+        trace::span traced{"bfw"};
+        vector<node_type> frontier;
+        for (node_type s : sources) {
+            if (!visited.set(s)) continue;
+            hops[s] = 0;
+            visit(s, token_node, 0);
+            frontier.push_back(s);
+        }
+
+        vector<vector<node_type> > next(threads);
+        vector<run_type> runs(threads);
+        vector<size_t> offsets(threads + 1);
+        for (node_type level = 1; !frontier.empty(); level++) {
+            size_t chunks = (frontier.size() + chunk_size - 1) / chunk_size;
+            for (unsigned int t = 0; t < threads; t++) {
+                runs[t].next.store(chunks * t / threads, memory_order_relaxed);
+                runs[t].end = chunks * (t + 1) / threads;
+            }
+            unsigned int active = static_cast<unsigned int>(min<size_t>(threads, chunks));
+            for (auto& part : next) part.clear();
+
+            parallel::parallel_do(active, [&](unsigned int t) {
+                    vector<node_type>& out = next[t];
+                    // own run first, then the others in turn
+                    for (unsigned int v = 0; v < threads; v++) {
+                        run_type& run = runs[(t + v) % threads];
+                        for (size_t c = run.next++; c < run.end; c = run.next++) {
+                            size_t last = min(frontier.size(), (c + 1) * chunk_size);
+                            for (size_t i = c * chunk_size; i < last; i++) {
+                                node_type n = frontier[i];
+                                for (auto& e : g[n]) {
+                                    node_type m = e.target();
+                                    if (visited.test(m) || !visited.set(m)) continue;
+                                    parents[m] = n;
+                                    hops[m] = level;
+                                    visit(m, n, level);
+                                    out.push_back(m);
+                                }
+                            }
+                        }
+                    }
+                });
+
+            for (unsigned int t = 0; t < threads; t++) offsets[t + 1] = offsets[t] + next[t].size();
+            frontier.resize(offsets[threads]);
+            parallel::parallel_do(active, [&](unsigned int t) {
+                    for (unsigned int u = t; u < threads; u += active) {
+                        copy(next[u].begin(), next[u].end(), frontier.begin() + offsets[u]);
+                    }
+                });
+        }
+    }
+
+
     /**
        TOPOLOGICAL SORT
     **/
@@ -133,21 +427,40 @@ namespace graph {
         cycle_found(edge_type e, parents_type p, string s) : logic_error{s}, edge(e), parents{p} {};
     };
     
+    namespace walk_support {
+
+        // collects post-order, and stops at the first back edge
+        template<class G>
+        class top_sort_visitor : public dfw_visitor<G> {
+        public:
+            using edge_type = typename G::edge_type;
+            using node_type = typename G::node_type;
+
+            vector<node_type>& results;
+            const edge_type* back_edge{nullptr};
+
+            top_sort_visitor(vector<node_type>& r) : results(r) {}
+
+            void post(node_type n) { results.push_back(n); }
+            void edge(const edge_type& e, edge_class c) { if (c == edge_class::back) back_edge = &e; }
+            bool finished() const { return back_edge != nullptr; }
+        };
+    }
+    
     template<class G>
     vector<typename G::node_type> top_sort(const G& g)
     {
+        trace::span traced{"top_sort"};
         using edge_type = typename G::edge_type;
         using node_type = typename G::node_type;
         vector<node_type> results;
-        dfw<G> walk{g};
-        walk.post = [&](node_type n) { results.push_back(n); };
-        walk.edge = [&](edge_type e) {
-            if (walk.classify_edge(e) == edge_class::back) {
-                throw cycle_found<edge_type>{e, walk.parents, "Cycle found"};
-            }
-        };
+        walk_support::top_sort_visitor<G> visitor{results};
+        static_dfw<G, walk_support::top_sort_visitor<G> > walk{g, visitor};
         for (node_type n = 0; n < g.node_count(); n++) {
             if (!walk.processed(n)) walk(g,n);
+            if (visitor.back_edge) {
+                throw cycle_found<edge_type>{*visitor.back_edge, walk.parents(), "Cycle found"};
+            }
         }
         return results;
     }
@@ -167,15 +480,37 @@ namespace graph {
        d is the reverse of the graph, computed using reverse(g)
     **/
     
+    namespace walk_support {
+
+        template<class G>
+        class post_order_visitor : public dfw_visitor<G> {
+        public:
+            using node_type = typename G::node_type;
+            vector<node_type>& order;
+            post_order_visitor(vector<node_type>& o) : order(o) {}
+            void post(node_type n) { order.push_back(n); }
+        };
+
+        template<class G>
+        class pre_order_visitor : public dfw_visitor<G> {
+        public:
+            using node_type = typename G::node_type;
+            vector<node_type>& order;
+            pre_order_visitor(vector<node_type>& o) : order(o) {}
+            void pre(node_type n) { order.push_back(n); }
+        };
+    }
+    
     template<class G>
     vector<vector<typename G::node_type>> scc(const G& g, const G& r)
     {
+        trace::span traced{"scc"};
         using node_type = typename G::node_type;
         
         // find completion times in primary graph
         vector<node_type> finish_times;
-        dfw<G> walk1{g};
-        walk1.post = [&](int node) { finish_times.push_back(node); };
+        walk_support::post_order_visitor<G> visitor1{finish_times};
+        static_dfw<G, walk_support::post_order_visitor<G> > walk1{g, visitor1};
         for (node_type n = 0; n < g.node_count(); n++) {
             if (!walk1.processed(n)) walk1(g,n);
         }
@@ -183,8 +518,8 @@ namespace graph {
         // collect components in reverse graph
         vector<vector<node_type>> result;
         vector<node_type> current;
-        dfw<G> walk2{r};
-        walk2.pre = [&](int node) { current.push_back(node); };
+        walk_support::pre_order_visitor<G> visitor2{current};
+        static_dfw<G, walk_support::pre_order_visitor<G> > walk2{r, visitor2};
         for (auto n = finish_times.rbegin(); n != finish_times.rend(); n++) {
             if (!walk2.processed(*n)) {
                 walk2(r, *n);
@@ -195,6 +530,309 @@ namespace graph {
         return result;
     }
 
+    /**
+       component_set - a partition of the nodes into components
+
+       The members of component c are nodes[offsets[c]] up to (not
+       including) nodes[offsets[c+1]], so the whole partition is two
+       flat arrays. ids[n] is the component holding node n.
+    **/
+
+    template<class N>
+    class component_set {
+    public:
+        using node_type = N;
+        using iterator = typename vector<node_type>::const_iterator;
+
+        vector<node_type> nodes;
+        vector<size_t> offsets{0};
+        vector<node_type> ids;
+
+        size_t size() const { return offsets.size() - 1; }
+        size_t size(size_t c) const { return offsets[c+1] - offsets[c]; }
+        iterator begin(size_t c) const { return nodes.begin() + offsets[c]; }
+        iterator end(size_t c) const { return nodes.begin() + offsets[c+1]; }
+
+        // fill nodes and offsets from ids, given the number of components
+        void group(size_t count);
+
+        // renumber the components in order of their smallest node, so
+        // that any two algorithms finding the same partition agree
+        void renumber();
+    };
+
+    template<class N>
+    void component_set<N>::group(size_t count)
+    {
+        offsets.assign(count + 1, 0);
+        for (node_type id : ids) offsets[id + 1]++;
+        for (size_t c = 0; c < count; c++) offsets[c + 1] += offsets[c];
+        nodes.resize(ids.size());
+        vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (size_t n = 0; n < ids.size(); n++) nodes[next[ids[n]]++] = static_cast<node_type>(n);
+    }
+
+    template<class N>
+    void component_set<N>::renumber()
+    {
+        const node_type token = numeric_limits<node_type>::max();
+        vector<node_type> new_ids(ids.size(), token);
+        node_type count = 0;
+        for (node_type& id : ids) {
+            if (new_ids[id] == token) new_ids[id] = count++;
+            id = new_ids[id];
+        }
+        group(count);
+    }
+
+    /**
+       pearce_scc - strongly connected components in one pass
+
+       Pearce's space efficient form of Tarjan's algorithm. Unlike
+       scc, this needs no reverse graph and walks g once. Besides the
+       result, it uses one word per node (rindex), a stack of nodes
+       waiting for their component, and the walk's own stack, so it
+       never recurses.
+
+       Components are numbered in the order they are completed, which
+       is a reverse topological order: every edge between components
+       runs from a higher id to a lower one.
+    **/
+
+    namespace walk_support {
+
+        // Pearce's algorithm, over the nodes n where allowed(n). Their
+        // rindex must start at 0; on return each holds
+        // rindex.size() - 1 - (its component id). Returns the number
+        // of components found.
+        template<class G, class P>
+        size_t pearce(const G& g, P allowed, vector<typename G::node_type>& rindex)
+        {
+            using node_type = typename G::node_type;
+            using frame_type = tuple<node_type, typename G::list_type::const_iterator, bool>;
+
+            const node_type count = static_cast<node_type>(rindex.size());
+            vector<node_type> waiting;
+            vector<frame_type> frames;
+            node_type index = 1;
+            node_type c = count - 1;
+
+            for (node_type start = 0; start < count; start++) {
+                if (rindex[start] != 0 || !allowed(start)) continue;
+                rindex[start] = index++;
+                frames.push_back(frame_type{start, g[start].begin(), true});
+                while (!frames.empty()) {
+                    node_type v = get<0>(frames.back());
+                    auto& next = get<1>(frames.back());
+                    if (next != g[v].end()) {
+                        node_type w = next->target();
+                        if (!allowed(w)) {
+                            ++next;
+                            continue;
+                        }
+                        if (rindex[w] == 0) {
+                            // descend; the edge is looked at again on return
+                            rindex[w] = index++;
+                            frames.push_back(frame_type{w, g[w].begin(), true});
+                            continue;
+                        }
+                        if (rindex[w] < rindex[v]) {
+                            rindex[v] = rindex[w];
+                            get<2>(frames.back()) = false;
+                        }
+                        ++next;
+                        continue;
+                    }
+                    bool root = get<2>(frames.back());
+                    frames.pop_back();
+                    if (root) {
+                        --index;
+                        while (!waiting.empty() && rindex[v] <= rindex[waiting.back()]) {
+                            rindex[waiting.back()] = c;
+                            waiting.pop_back();
+                            --index;
+                        }
+                        rindex[v] = c--;
+                    } else {
+                        waiting.push_back(v);
+                    }
+                    if (!frames.empty()) {
+                        node_type p = get<0>(frames.back());
+                        if (rindex[v] < rindex[p]) {
+                            rindex[p] = rindex[v];
+                            get<2>(frames.back()) = false;
+                        }
+                        ++get<1>(frames.back());
+                    }
+                }
+            }
+            return static_cast<node_type>(count - 1 - c);
+        }
+    }
+
+    template<class G>
+    component_set<typename G::node_type> pearce_scc(const G& g)
+    {
+        trace::span traced{"pearce_scc"};
+        using node_type = typename G::node_type;
+
+        // rindex is worked in place, in the result's ids
+        component_set<node_type> result;
+        result.ids.assign(g.node_count(), 0);
+        size_t count = walk_support::pearce(g, [](node_type) { return true; }, result.ids);
+        for (node_type& id : result.ids) id = g.node_count() - 1 - id;
+        result.group(count);
+        return result;
+    }
+
+
+    /**
+       PARALLEL TOPOLOGICAL SORT
+    **/
+
+    /**
+       cyclic_component - thrown by top_levels when g has a cycle
+
+       Besides the cycle_found data (an edge on a cycle, and parents
+       leading from its source round to its target), this holds every
+       node of one strongly connected component that has a cycle, and
+       that no other such component leads into.
+    **/
+
+    template<class E>
+    class cyclic_component : public cycle_found<E> {
+    public:
+        using edge_type = E;
+        using parents_type = typename cycle_found<E>::parents_type;
+        using node_type = typename edge_type::node_type;
+        vector<node_type> component;
+        cyclic_component(edge_type e, parents_type p, vector<node_type> c, string s) :
+            cycle_found<E>{e, p, s}, component(c) {}
+    };
+
+    namespace walk_support {
+
+        // throws cyclic_component for the nodes not placed (whose
+        // counted in degree is not zero), of which some must be cyclic
+        template<class G>
+        void throw_cyclic_component(const G& g, const vector<atomic<typename G::node_type> >& in_degree)
+        {
+            using edge_type = typename G::edge_type;
+            using node_type = typename G::node_type;
+            const node_type count = g.node_count();
+            const node_type token_node = numeric_limits<node_type>::max();
+            auto left = [&](node_type n) { return in_degree[n].load() != 0; };
+
+            vector<node_type> rindex(count, 0);
+            walk_support::pearce(g, left, rindex);
+
+            // components finish in reverse topological order, so take
+            // the cyclic one found last
+            node_type best = token_node;
+            const edge_type* cycle_edge = nullptr;
+            for (node_type n = 0; n < count; n++) {
+                if (!left(n) || (best != token_node && rindex[n] >= rindex[best])) continue;
+                for (auto& e : g[n]) {
+                    if (left(e.target()) && rindex[e.target()] == rindex[n]) {
+                        best = n;
+                        cycle_edge = &e;
+                        break;
+                    }
+                }
+            }
+
+            vector<node_type> component;
+            for (node_type n = 0; n < count; n++) {
+                if (left(n) && rindex[n] == rindex[best]) component.push_back(n);
+            }
+
+            // search the component from the edge's target, so the
+            // parents lead back from anywhere in it
+            vector<node_type> parents(count, token_node);
+            vector<node_type> frontier{cycle_edge->target()};
+            parents[cycle_edge->target()] = cycle_edge->target();
+            for (size_t i = 0; i < frontier.size(); i++) {
+                for (auto& e : g[frontier[i]]) {
+                    node_type t = e.target();
+                    if (parents[t] == token_node && left(t) && rindex[t] == rindex[best]) {
+                        parents[t] = frontier[i];
+                        frontier.push_back(t);
+                    }
+                }
+            }
+            parents[cycle_edge->target()] = token_node;
+            throw cyclic_component<edge_type>{*cycle_edge, parents, component, "Cycle found"};
+        }
+    }
+
+    /**
+       top_levels - topological sort, grouped into levels
+
+       Returns the nodes of g in levels: level 0 holds the nodes with
+       no in edges, and each node is in the level just after the last
+       of its sources. So everything a node depends on is in an
+       earlier level, and the nodes of one level can be run at once.
+       Within a level the nodes are sorted.
+
+       This is Kahn's algorithm, one level at a time, with in degrees
+       counted down atomically by the threads. Each level gets a team
+       sized to it (see parallel::team_size), so the narrow levels of
+       a long chain run without starting threads. Unlike top_sort, the
+       order is forward.
+
+       If g has a cycle, throws cyclic_component.
+    **/
+
+    template<class G>
+    vector<vector<typename G::node_type> > top_levels(const G& g,
+                                                      unsigned int threads = parallel::default_threads())
+    {
+        trace::span traced{"top_levels"};
+        using node_type = typename G::node_type;
+        const node_type count = g.node_count();
+
+        vector<atomic<node_type> > in_degree(count);
+        for (auto& d : in_degree) d.store(0, memory_order_relaxed);
+        parallel::parallel_for(0, count, threads, [&](size_t n) {
+                for (auto& e : g[n]) in_degree[e.target()].fetch_add(1, memory_order_relaxed);
+            });
+
+        vector<vector<node_type> > levels(1);
+        for (node_type n = 0; n < count; n++) {
+            if (in_degree[n].load(memory_order_relaxed) == 0) levels[0].push_back(n);
+        }
+
+        size_t placed = 0;
+        const size_t chunk = 256;
+        vector<vector<node_type> > next(max(threads, 1u));
+        while (!levels.back().empty()) {
+            const vector<node_type>& level = levels.back();
+            placed += level.size();
+            atomic<size_t> position{0};
+            // threads left out of this level's team will not clear
+            // their own buffers
+            for (auto& part : next) part.clear();
+            parallel::parallel_do(parallel::team_size(level.size(), threads, chunk), [&](unsigned int t) {
+                    vector<node_type>& out = next[t];
+                    for (size_t b = position.fetch_add(chunk); b < level.size(); b = position.fetch_add(chunk)) {
+                        for (size_t i = b; i < min(b + chunk, level.size()); i++) {
+                            for (auto& e : g[level[i]]) {
+                                if (in_degree[e.target()].fetch_sub(1, memory_order_acq_rel) == 1) out.push_back(e.target());
+                            }
+                        }
+                    }
+                });
+            vector<node_type> joined;
+            for (auto& part : next) joined.insert(joined.end(), part.begin(), part.end());
+            sort(joined.begin(), joined.end());
+            levels.push_back(move(joined));
+        }
+        levels.pop_back();
+
+        if (placed < count) walk_support::throw_cyclic_component(g, in_degree);
+        return levels;
+    }
+
 }
 
 
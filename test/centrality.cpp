@@ -0,0 +1,224 @@
+#include <cmath>
+#include <random>
+#include <string>
+#include <numeric>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "heaps.h"
+#include "centrality.h"
+
+#include "graph_utils.h"
+
+using namespace std;
+using namespace graph;
+
+using basic_graph_type = graph<edge<>>;
+using weighted_graph_type = graph<weighted_edge<> >;
+using fractional_graph_type = graph<weighted_edge<double> >;
+using node_type = basic_graph_type::node_type;
+
+// the cost of an edge, one where there is no weight
+double cost(const edge<>&) { return 1; }
+template<class W> double cost(const weighted_edge<W>& e) { return static_cast<double>(e.weight()); }
+
+// betweenness straight from its definition, over all pairs shortest
+// paths and path counts from a dense matrix, to check against
+template<class G>
+vector<double> all_pairs_betweenness(const G& g)
+{
+    const double none = numeric_limits<double>::infinity();
+    node_type n = g.node_count();
+    vector<vector<double> > costs(n, vector<double>(n, none));
+    for (node_type s = 0; s < n; s++) costs[s][s] = 0;
+    for (auto& e : g) if (e.source() != e.target()) costs[e.source()][e.target()] = cost(e);
+    for (node_type k = 0; k < n; k++)
+        for (node_type s = 0; s < n; s++)
+            for (node_type t = 0; t < n; t++)
+                costs[s][t] = min(costs[s][t], costs[s][k] + costs[k][t]);
+
+    // paths[s][t], taking the nodes in order of cost from s
+    vector<vector<double> > paths(n, vector<double>(n, 0));
+    for (node_type s = 0; s < n; s++) {
+        vector<node_type> order(n);
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](node_type a, node_type b) { return costs[s][a] < costs[s][b]; });
+        paths[s][s] = 1;
+        for (node_type u : order) {
+            if (costs[s][u] == none) break;
+            for (auto& e : g[u]) {
+                if (e.target() != u && costs[s][u] + cost(e) == costs[s][e.target()]) paths[s][e.target()] += paths[s][u];
+            }
+        }
+    }
+
+    vector<double> result(n, 0);
+    for (node_type s = 0; s < n; s++)
+        for (node_type t = 0; t < n; t++)
+            for (node_type v = 0; v < n; v++) {
+                if (s == t || v == s || v == t || costs[s][t] == none) continue;
+                if (costs[s][v] + costs[v][t] == costs[s][t]) result[v] += paths[s][v] * paths[v][t] / paths[s][t];
+            }
+    return result;
+}
+
+void verify_scores(const string& name, const vector<double>& scores, const vector<double>& expected)
+{
+    if (scores.size() != expected.size()) {
+        cout << name << " failed, " << scores.size() << " scores\n";
+        exit(1);
+    }
+    for (size_t n = 0; n < scores.size(); n++) {
+        if (fabs(scores[n] - expected[n]) > 1e-9 * max(1.0, expected[n])) {
+            cout << name << " failed at " << n << ", " << scores[n] << " expected " << expected[n] << '\n';
+            exit(1);
+        }
+    }
+}
+
+void test_betweenness()
+{
+    // a path, both ways: node i lies between the i nodes before it
+    // and the 4 - i after, in either direction
+    basic_graph_type path {{0,1},{1,0},{1,2},{2,1},{2,3},{3,2},{3,4},{4,3}};
+    verify_scores("Betweenness", betweenness(path, 1), {0, 6, 8, 6, 0});
+
+    // two equal paths from 0 to 3, so each middle node gets half
+    basic_graph_type diamond {{0,1},{0,2},{1,3},{2,3},{3,3}};
+    verify_scores("Betweenness", betweenness(diamond, 2), {0, 0.5, 0.5, 0});
+
+    // the long way round is cheaper by weight, or ties with it
+    weighted_graph_type cheaper {{0,1,1},{1,2,1},{0,2,3}};
+    verify_scores("Betweenness, weighted", betweenness(cheaper, 1), {0, 1, 0});
+    weighted_graph_type tied {{0,1,1},{1,2,1},{0,2,2}};
+    verify_scores("Betweenness, weighted", betweenness(tied, 1), {0, 0.5, 0});
+    verify_scores("Betweenness, weighted", betweenness<pairing_heap>(tied, 1), {0, 0.5, 0});
+    cout << "Betweenness passed\n";
+}
+
+template<class G, class W>
+void verify_random(const string& name, unsigned int seed, W weight)
+{
+    mt19937 rnd(seed);
+    for (int round = 0; round < 20; round++) {
+        node_type nodes = 2 + rnd() % 60;
+        size_t edges = rnd() % (nodes * 4);
+        G g;
+        g += {nodes - 1, nodes - 1, weight(rnd)};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t, weight(rnd)};
+        }
+        vector<double> expected = all_pairs_betweenness(g);
+        verify_scores(name, betweenness<pairing_heap>(g, 1), expected);
+        verify_scores(name, betweenness<pairing_heap>(g, 1 + round % 5), expected);
+    }
+}
+
+void test_betweenness_random()
+{
+    mt19937 rnd(50);
+    for (int round = 0; round < 20; round++) {
+        node_type nodes = 2 + rnd() % 60;
+        size_t edges = rnd() % (nodes * 4);
+        basic_graph_type g;
+        g += {nodes - 1, nodes - 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t};
+        }
+        vector<double> expected = all_pairs_betweenness(g);
+        verify_scores("Betweenness random graphs", betweenness(g, 1), expected);
+        verify_scores("Betweenness random graphs", betweenness(g, 1 + round % 5), expected);
+    }
+
+    // few distinct weights, so that many paths tie
+    verify_random<weighted_graph_type>("Betweenness, weighted random graphs", 51,
+                                       [](mt19937& r) { return 1 + r() % 3; });
+    verify_random<fractional_graph_type>("Betweenness, fractional random graphs", 52,
+                                         [](mt19937& r) { return 0.5 + (r() % 4) * 0.25; });
+
+    // the dial heap, on integral weights
+    weighted_graph_type g;
+    for (node_type n = 0; n < 40; n++) {
+        g += {n, (n * 7 + 3) % 41, 1 + n % 4};
+        g += {n, (n * 11 + 5) % 41, 1 + n % 3};
+    }
+    verify_scores("Betweenness, dial heap", betweenness(g, 3), all_pairs_betweenness(g));
+
+    // a wide range of weights, for which the heap is made once a thread
+    weighted_graph_type wide;
+    for (node_type n = 0; n < 40; n++) {
+        wide += {n, (n * 7 + 3) % 41, 1 + (n % 4) * 250000};
+        wide += {n, (n * 11 + 5) % 41, 1 + (n % 3) * 500000};
+    }
+    verify_scores("Betweenness, wide weights", betweenness(wide, 2), all_pairs_betweenness(wide));
+
+    // fractional weights take the pairing heap by default
+    fractional_graph_type fractional;
+    for (node_type n = 0; n < 40; n++) {
+        fractional += {n, (n * 7 + 3) % 41, 0.5 + (n % 4) * 0.25};
+        fractional += {n, (n * 11 + 5) % 41, 0.5 + (n % 3) * 0.25};
+    }
+    verify_scores("Betweenness, fractional", betweenness(fractional, 3), all_pairs_betweenness(fractional));
+    verify_scores("Betweenness, fractional", approximate_betweenness(fractional, 41, 1, 2),
+                  all_pairs_betweenness(fractional));
+    cout << "Betweenness random graphs passed\n";
+}
+
+void test_approximate_betweenness()
+{
+    mt19937 rnd(500);
+    basic_graph_type g;
+    node_type nodes = 3000;
+    for (size_t i = 0; i < nodes * 4; i++) {
+        node_type s = rnd() % nodes;
+        node_type t = rnd() % nodes;
+        if (!g.contains_edge({s, t})) g += {s, t};
+    }
+    g += {nodes - 1, nodes - 1};
+
+    // enough samples is exact
+    vector<double> exact = betweenness(g, 4);
+    verify_scores("Approximate betweenness", approximate_betweenness(g, nodes, 1, 2), exact);
+
+    // the same seed and threads give the same sample
+    vector<double> estimate = approximate_betweenness(g, 300, 7, 3);
+    if (estimate != approximate_betweenness(g, 300, 7, 3) || estimate == approximate_betweenness(g, 300, 8, 3)) {
+        cout << "Approximate betweenness failed, not repeatable\n";
+        exit(1);
+    }
+
+    // a tenth of the sources finds the total to within a few
+    // percent; single nodes vary more, but are right on average
+    double exact_total = accumulate(exact.begin(), exact.end(), 0.0);
+    double estimate_total = accumulate(estimate.begin(), estimate.end(), 0.0);
+    if (fabs(estimate_total - exact_total) > 0.05 * exact_total) {
+        cout << "Approximate betweenness failed, total " << estimate_total << " expected " << exact_total << '\n';
+        exit(1);
+    }
+    node_type busiest = max_element(exact.begin(), exact.end()) - exact.begin();
+    double mean = 0;
+    for (unsigned int seed = 0; seed < 10; seed++) mean += approximate_betweenness(g, 300, seed, 2)[busiest] / 10;
+    if (fabs(mean - exact[busiest]) > 0.2 * exact[busiest]) {
+        cout << "Approximate betweenness failed, busiest " << mean << " expected " << exact[busiest] << '\n';
+        exit(1);
+    }
+
+    if (approximate_betweenness(g, 0) != vector<double>(nodes, 0)) {
+        cout << "Approximate betweenness failed, no samples\n";
+        exit(1);
+    }
+    cout << "Approximate betweenness passed\n";
+}
+
+int main()
+{
+    cout << "Testing centrality\n";
+    test_betweenness();
+    test_betweenness_random();
+    test_approximate_betweenness();
+}
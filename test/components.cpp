@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <random>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "walks.h"
+#include "components.h"
+
+#include "graph_utils.h"
+
+using namespace std;
+using namespace graph;
+
+using basic_graph_type = graph<edge<>>;
+using node_type = basic_graph_type::node_type;
+
+// compares par_scc with pearce_scc, for the given cutoff and threads
+void verify_par_scc(const basic_graph_type& g, unsigned int threads, size_t cutoff)
+{
+    component_set<node_type> expected = pearce_scc(g);
+    expected.renumber();
+    component_set<node_type> result = par_scc(g, reverse(g), threads, cutoff);
+    if (result.ids != expected.ids || result.nodes != expected.nodes || result.offsets != expected.offsets) {
+        cout << "Parallel SCC Failed!\n";
+        cout << "threads " << threads << ", cutoff " << cutoff << '\n';
+        print_graph(g);
+        for (node_type n = 0; n < g.node_count(); n++) {
+            cout << n << ' ' << expected.ids[n] << ' ' << result.ids[n] << '\n';
+        }
+        exit(1);
+    }
+}
+
+void test_par_scc()
+{
+    basic_graph_type g {{0,1}, {1,2}, {1,3},
+                       {1,4},
+                       {2,0},
+                       {3,0}, {3,5}, {3,7},
+                       {4,5},
+                       {5,6},
+                       {6,4},
+                       {7,5}};
+    for (unsigned int threads : {1, 4}) {
+        verify_par_scc(g, threads, 0);
+        verify_par_scc(g, threads, 100);
+    }
+    cout << "Parallel SCC passed\n";
+}
+
+void test_par_scc_random()
+{
+    mt19937 rnd(34);
+    for (int round = 0; round < 40; round++) {
+        // sparse enough to leave many components of all sizes
+        node_type nodes = 50 + rnd() % 2000;
+        size_t edges = nodes + rnd() % (nodes * 2);
+        basic_graph_type g;
+        g += {nodes - 1, nodes - 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t};
+        }
+        verify_par_scc(g, 1 + round % 4, round % 3 == 0 ? 0 : nodes / 4);
+    }
+    cout << "Parallel SCC random graphs passed\n";
+}
+
+// a long path, peeled one node per trim round, into a long ring,
+// searched one node per level; bench times it on one thread and many
+void test_par_scc_long()
+{
+    const node_type half = 50000;
+    basic_graph_type g;
+    for (node_type n = 0; n + 1 < 2 * half; n++) g += {n, n + 1};
+    g += {2 * half - 1, half};
+    basic_graph_type r = reverse(g);
+    for (unsigned int threads : {1, 8}) {
+        component_set<node_type> result = par_scc(g, r, threads, 0);
+        if (result.size() != half + 1 || result.size(result.ids[half]) != half) {
+            cout << "Parallel SCC, long path failed, " << result.size() << " components\n";
+            exit(1);
+        }
+    }
+    cout << "Parallel SCC, long path passed\n";
+}
+
+// a chain of 2-cycles, each with an edge down to the one below: no
+// node trims, and each coloring pass would settle only after a round
+// per node, to claim just the top pair
+void test_par_scc_chain()
+{
+    const node_type pairs = 10000;
+    basic_graph_type g;
+    for (node_type k = 0; k < pairs; k++) {
+        g += {2 * k, 2 * k + 1};
+        g += {2 * k + 1, 2 * k};
+        if (k > 0) g += {2 * k, 2 * k - 1};
+    }
+    for (unsigned int threads : {1, 4}) {
+        verify_par_scc(g, threads, 0);
+        verify_par_scc(g, threads, 10000);
+    }
+    cout << "Parallel SCC, chain of cycles passed\n";
+}
+
+void verify_connected(const basic_graph_type& g, unsigned int threads)
+{
+    // the undirected graph holds every edge both ways
+    basic_graph_type u = g;
+    for (auto e : g) if (!u.contains_edge({e.target(), e.source()})) u += reverse_edge(e);
+    component_set<node_type> expected = pearce_scc(u);
+    expected.renumber();
+    component_set<node_type> result = connected_components(g, threads);
+    if (result.ids != expected.ids || result.offsets != expected.offsets) {
+        cout << "Connected Components Failed!\n";
+        print_graph(g);
+        exit(1);
+    }
+}
+
+void test_connected_components()
+{
+    basic_graph_type g {{0,1}, {2,1}, {3,4}, {5,5}, {6,4}, {6,7}, {9,8}};
+    component_set<node_type> result = connected_components(g, 2);
+    vector<node_type> expected{0, 0, 0, 1, 1, 2, 1, 1, 3, 3};
+    if (result.ids != expected || result.size() != 4 || result.size(1) != 4) {
+        cout << "Connected Components Failed!\n";
+        exit(1);
+    }
+    mt19937 rnd(38);
+    for (int round = 0; round < 30; round++) {
+        node_type nodes = 50 + rnd() % 5000;
+        size_t edges = rnd() % nodes;
+        basic_graph_type h;
+        h += {nodes - 1, nodes - 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!h.contains_edge({s, t})) h += {s, t};
+        }
+        verify_connected(h, 1 + round % 4);
+    }
+    cout << "Connected Components passed\n";
+}
+
+int main()
+{
+    cout << "Testing components\n";
+    test_par_scc();
+    test_par_scc_random();
+    test_par_scc_long();
+    test_par_scc_chain();
+    test_connected_components();
+}
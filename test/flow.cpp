@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "flow.h"
+
+#include "graph_utils.h"
+
+using namespace std;
+using namespace graph;
+
+using capacity_graph_type = graph<weighted_edge<> >;
+using fractional_graph_type = graph<weighted_edge<double> >;
+using node_type = capacity_graph_type::node_type;
+
+// the value of a maximum flow, by shortest augmenting paths over a
+// dense matrix, to check against
+template<class G>
+double augmenting_paths(const G& g, node_type source, node_type sink)
+{
+    node_type n = g.node_count();
+    vector<vector<double> > residual(n, vector<double>(n, 0));
+    for (auto& e : g) if (e.source() != e.target()) residual[e.source()][e.target()] += e.weight();
+    double total = 0;
+    for (;;) {
+        vector<node_type> parent(n, n);
+        parent[source] = source;
+        vector<node_type> queue{source};
+        for (size_t i = 0; i < queue.size() && parent[sink] == n; i++) {
+            for (node_type m = 0; m < n; m++) {
+                if (parent[m] == n && residual[queue[i]][m] > 1e-12) {
+                    parent[m] = queue[i];
+                    queue.push_back(m);
+                }
+            }
+        }
+        if (parent[sink] == n) return total;
+        double delta = numeric_limits<double>::max();
+        for (node_type m = sink; m != source; m = parent[m]) delta = min(delta, residual[parent[m]][m]);
+        for (node_type m = sink; m != source; m = parent[m]) {
+            residual[parent[m]][m] -= delta;
+            residual[m][parent[m]] += delta;
+        }
+        total += delta;
+    }
+}
+
+// capacities kept, flow conserved, and the cut as large as the flow
+template<class G>
+void verify_flow(const string& name, const G& g, node_type source, node_type sink,
+                 const flow_result<G>& result, double tolerance)
+{
+    node_type n = g.node_count();
+    vector<double> balance(n, 0);
+    G flows;
+    flows.insert(result.flows.begin(), result.flows.end());
+    auto f = result.flows.begin();
+    for (auto& e : g) {
+        const typename G::edge_type& carried = *f++;
+        if (carried.source() != e.source() || carried.target() != e.target()) {
+            cout << name << " failed, flows out of order\n";
+            exit(1);
+        }
+        double flow = carried.weight();
+        if (flow < -tolerance || flow > e.weight() + tolerance) {
+            cout << name << " failed, capacity broken on " << e << '\n';
+            exit(1);
+        }
+        if (e.source() == e.target()) continue;
+        balance[e.source()] -= flow;
+        balance[e.target()] += flow;
+    }
+    for (node_type m = 0; m < n; m++) {
+        double expected = m == source ? -static_cast<double>(result.value)
+            : m == sink ? static_cast<double>(result.value) : 0.0;
+        if (fabs(balance[m] - expected) > tolerance) {
+            cout << name << " failed, flow not conserved at " << m << '\n';
+            exit(1);
+        }
+    }
+    double cut = 0;
+    for (auto& e : result.cut) {
+        double flow = flows.edge_at({e.source(), e.target()}).weight();
+        if (fabs(flow - e.weight()) > tolerance) {
+            cout << name << " failed, cut edge " << e << " not saturated\n";
+            exit(1);
+        }
+        cut += e.weight();
+    }
+    if (!result.source_side[source] || result.source_side[sink] || fabs(cut - result.value) > tolerance) {
+        cout << name << " failed, bad cut\n";
+        exit(1);
+    }
+}
+
+void test_max_flow()
+{
+    capacity_graph_type g {{0,1,16},{0,2,13},
+                           {1,3,12},
+                           {2,1,4},{2,4,14},
+                           {3,2,9},{3,5,20},
+                           {4,3,7},{4,5,4},
+                           {5,5,3},{6,0,5}};
+    flow_result<capacity_graph_type> result = max_flow(g, 0, 5);
+    verify_flow("Maximum flow", g, 0, 5, result, 0);
+    vector<bool> side{true, true, true, false, true, false, false};
+    if (result.value != 23 || result.cut.size() != 3 || result.source_side != side) {
+        cout << "Maximum flow failed, value " << result.value << '\n';
+        exit(1);
+    }
+    // nothing reaches 6
+    if (max_flow(g, 0, 6).value != 0) {
+        cout << "Maximum flow failed, unreachable sink\n";
+        exit(1);
+    }
+    try {
+        max_flow(g, 2, 2);
+        cout << "Maximum flow failed, source is sink\n";
+        exit(1);
+    } catch (invalid_argument&) {
+    }
+    cout << "Maximum flow passed\n";
+}
+
+void test_max_flow_random()
+{
+    mt19937 rnd(49);
+    for (int round = 0; round < 60; round++) {
+        node_type nodes = 2 + rnd() % 120;
+        size_t edges = rnd() % (nodes * 6);
+        unsigned long capacities = 1 + rnd() % 100;
+        capacity_graph_type g;
+        g += {nodes - 1, nodes - 1, 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t, rnd() % capacities};
+        }
+        node_type source = rnd() % nodes;
+        node_type sink = (source + 1 + rnd() % (nodes - 1)) % nodes;
+        flow_result<capacity_graph_type> result = max_flow(g, source, sink);
+        verify_flow("Maximum flow random graphs", g, source, sink, result, 0);
+        if (result.value != augmenting_paths(g, source, sink)) {
+            cout << "Maximum flow random graphs failed, value " << result.value
+                 << " expected " << augmenting_paths(g, source, sink) << '\n';
+            print_graph(g);
+            exit(1);
+        }
+    }
+    cout << "Maximum flow random graphs passed\n";
+}
+
+void test_max_flow_fractional()
+{
+    mt19937 rnd(490);
+    uniform_real_distribution<double> capacity(0.0, 5.0);
+    for (int round = 0; round < 10; round++) {
+        fractional_graph_type g;
+        node_type nodes = 200;
+        g += {nodes - 1, nodes - 1, 0};
+        for (size_t i = 0; i < nodes * 5; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t, capacity(rnd)};
+        }
+        flow_result<fractional_graph_type> result = max_flow(g, 0, nodes - 1);
+        verify_flow("Maximum flow, fractional", g, 0, nodes - 1, result, 1e-9);
+        if (fabs(result.value - augmenting_paths(g, 0, nodes - 1)) > 1e-9) {
+            cout << "Maximum flow, fractional failed\n";
+            exit(1);
+        }
+    }
+    cout << "Maximum flow, fractional passed\n";
+}
+
+int main()
+{
+    cout << "Testing maximum flow\n";
+    test_max_flow();
+    test_max_flow_random();
+    test_max_flow_fractional();
+}
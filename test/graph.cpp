@@ -1,8 +1,11 @@
 #include <algorithm>
 #include <vector>
+#include <cmath>
+#include <cstdlib>
 
 #include "graph.h"
 #include "edge.h"
+#include "random_graphs.h"
 
 #include "graph_utils.h"
 
@@ -100,6 +103,142 @@ void test_edges_at(graph_type g,
     cout << "Edges at passed\n";
 }
 
+void test_bulk_insert()
+{
+    vector<graph_type::edge_type> edges;
+    for (auto e : gr) edges.push_back(e);
+    graph_type g;
+    g.insert(edges.begin(), edges.end());
+    if (g.node_count() != gr.node_count() || g.edge_count() != gr.edge_count()) {
+        cout << "Bulk insert failed\n";
+        print_graph(g);
+        exit(1);
+    }
+    for (auto e : gr) {
+        if (!g.contains_edge({e.source(), e.target()}) || g.edge_at({e.source(), e.target()}).weight() != e.weight()) {
+            cout << "Bulk insert failed, missing " << e << '\n';
+            exit(1);
+        }
+    }
+    cout << "Bulk insert passed\n";
+}
+
+void test_rnd_epsilon_dense()
+{
+    using basic_graph_type = graph<edge<> >;
+    auto make = [](node_type s, node_type t) { return edge<>{s, t}; };
+    auto same = [](const basic_graph_type& a, const basic_graph_type& b) {
+        if (a.edge_count() != b.edge_count()) return false;
+        for (auto e : a) if (!b.contains_edge({e.source(), e.target()})) return false;
+        return true;
+    };
+
+    basic_graph_type complete = rnd_epsilon_dense<basic_graph_type>(30, 1.0, make, 1, 3);
+    basic_graph_type none = rnd_epsilon_dense<basic_graph_type>(30, 0.0, make, 1, 3);
+    if (complete.edge_count() != 900 || none.edge_count() != 0) {
+        cout << "Random dense graph failed, wrong edge count\n";
+        exit(1);
+    }
+
+    // about p * n * n edges, and the same graph for the same seed and threads
+    const node_type n = 2000;
+    const double p = 0.01;
+    basic_graph_type a = rnd_epsilon_dense<basic_graph_type>(n, p, make, 7, 4);
+    basic_graph_type b = rnd_epsilon_dense<basic_graph_type>(n, p, make, 7, 4);
+    basic_graph_type c = rnd_epsilon_dense<basic_graph_type>(n, p, make, 8, 4);
+    double expected = p * n * n;
+    if (a.edge_count() < expected * 0.95 || a.edge_count() > expected * 1.05) {
+        cout << "Random dense graph failed, " << a.edge_count() << " edges\n";
+        exit(1);
+    }
+    if (!same(a, b) || same(a, c)) {
+        cout << "Random dense graph failed, not repeatable\n";
+        exit(1);
+    }
+    cout << "Random dense graph passed\n";
+}
+
+void test_rnd_spatial()
+{
+    const node_type w = 60;
+    const double base = 0.8, slope = 0.5;
+    auto make = [](node_type s, node_type t, double d) {
+        return weighted_edge<>{s, t, static_cast<weight_type>(ceil(d * 10))};
+    };
+    vector<pair<double, double> > place;
+    graph_type a = rnd_spatial<graph_type>(w, base, slope, make, 3, 4, &place);
+    graph_type b = rnd_spatial<graph_type>(w, base, slope, make, 3, 4);
+
+    // the expected edge count, summed over every pair of cells
+    double expected = 0;
+    for (long i = 0; i < w; i++) for (long j = 0; j < w; j++) {
+            for (long k = 0; k < w; k++) for (long l = 0; l < w; l++) {
+                    long d = max(labs(i - k), labs(j - l));
+                    if (d > 0) expected += min(1.0, base / (4 * slope * d * d));
+                }
+        }
+    bool failed = a.edge_count() < expected * 0.95 || a.edge_count() > expected * 1.05;
+    failed = failed || a.edge_count() != b.edge_count() || place.size() != w * w;
+    for (auto e : a) {
+        auto& p = place[e.source()];
+        auto& q = place[e.target()];
+        double d = hypot(p.first - q.first, p.second - q.second);
+        if (e.source() == e.target() || e.weight() < d * 10 || !b.contains_edge({e.source(), e.target()})) failed = true;
+    }
+    for (node_type n = 0; n < place.size(); n++) {
+        if (floor(place[n].first) != n / w || floor(place[n].second) != n % w) failed = true;
+    }
+    if (failed) {
+        cout << "Random spatial graph failed, " << a.edge_count() << " edges, expected " << expected << '\n';
+        exit(1);
+    }
+    cout << "Random spatial graph passed\n";
+}
+
+void test_rnd_rmat()
+{
+    using basic_graph_type = graph<edge<> >;
+    auto make = [](node_type s, node_type t) { return edge<>{s, t}; };
+    basic_graph_type a = rnd_rmat<basic_graph_type>(12, 8, 0.57, 0.19, 0.19, make, 5, 3);
+    basic_graph_type b = rnd_rmat<basic_graph_type>(12, 8, 0.57, 0.19, 0.19, make, 5, 3);
+
+    // repeats are dropped, and the degrees are skewed
+    size_t most = 0;
+    for (node_type n = 0; n < a.node_count(); n++) most = max(most, a[n].size());
+    bool failed = a.edge_count() > 8 * 4096 || a.edge_count() < 4096 || a.node_count() > 4096;
+    failed = failed || most < 20 * a.edge_count() / 4096 || a.edge_count() != b.edge_count();
+    for (auto e : a) if (!b.contains_edge({e.source(), e.target()})) failed = true;
+    if (failed) {
+        cout << "R-MAT graph failed, " << a.edge_count() << " edges, largest degree " << most << '\n';
+        exit(1);
+    }
+    cout << "R-MAT graph passed\n";
+}
+
+void test_rnd_preferential()
+{
+    using basic_graph_type = graph<edge<> >;
+    auto make = [](node_type s, node_type t) { return edge<>{s, t}; };
+    const node_type n = 20000;
+    const unsigned int m = 3;
+    basic_graph_type a = rnd_preferential<basic_graph_type>(n, m, make, 9);
+    basic_graph_type b = rnd_preferential<basic_graph_type>(n, m, make, 9);
+
+    // edges point back to older nodes, and the oldest become hubs
+    vector<size_t> in_degree(a.node_count());
+    bool failed = a.edge_count() > n * m || a.edge_count() < n * m * 9 / 10 || a.edge_count() != b.edge_count();
+    for (auto e : a) {
+        if (e.target() >= e.source() || !b.contains_edge({e.source(), e.target()})) failed = true;
+        in_degree[e.target()]++;
+    }
+    size_t most = *max_element(in_degree.begin(), in_degree.end());
+    if (failed || most < 50 * m) {
+        cout << "Preferential attachment graph failed, " << a.edge_count() << " edges, largest in degree " << most << '\n';
+        exit(1);
+    }
+    cout << "Preferential attachment graph passed\n";
+}
+
 int main()
 {
     cout << "Testing graph access and iteration\n";
@@ -112,6 +251,11 @@ int main()
     test_contains_edge(gr, {{1,2},{2,1},{1,3}}, {{3,3},{0,3}});
     test_delete_edges(gr, {{1,2},{5,4},{1,3}}, {2,8,6,0,1,7,6,4});
     test_edges_at(gr, {{0,1},{5,4}}, 7, {7,8,5,3,6,0,1,7,6,4,7});
+    test_bulk_insert();
+    test_rnd_epsilon_dense();
+    test_rnd_spatial();
+    test_rnd_rmat();
+    test_rnd_preferential();
 }
 
 // End of file
@@ -0,0 +1,137 @@
+// every new and delete in this program goes through the tracker
+#define GRAPH_TRACK_ALLOCATIONS
+
+#include <cmath>
+#include <list>
+#include <vector>
+#include <random>
+#include <iostream>
+
+#include "memory.h"
+#include "graph.h"
+#include "edge.h"
+#include "heaps.h"
+#include "shortest_paths.h"
+
+using namespace std;
+using namespace graph;
+
+using weighted_graph_type = graph<weighted_edge<> >;
+using node_type = weighted_graph_type::node_type;
+
+// the estimate must be within a tenth of what was measured
+void check_close(const string& name, size_t estimated, size_t measured)
+{
+    double error = fabs(static_cast<double>(estimated) - static_cast<double>(measured));
+    if (measured == 0 || error > 0.1 * measured) {
+        cout << name << " failed, estimated " << estimated << " measured " << measured << '\n';
+        exit(1);
+    }
+}
+
+void test_graph_memory()
+{
+    mt19937 rnd(47);
+    memory::tracker& t = memory::global_tracker();
+    for (node_type nodes : {100u, 5000u, 50000u}) {
+        size_t before = t.current();
+        weighted_graph_type* g = new weighted_graph_type;
+        for (size_t i = 0; i < nodes * 4; i++) {
+            node_type s = rnd() % nodes;
+            node_type u = rnd() % nodes;
+            if (!g->contains_edge({s, u})) *g += {s, u, 1 + rnd() % 10};
+        }
+        size_t measured = t.current() - before - sizeof(weighted_graph_type);
+        {
+            memory::report r = g->memory_usage();
+            check_close("Graph memory", r.total(), measured);
+            if (r["adjacency"] == 0 || r["index"] == 0 || r["index buckets"] == 0 || r["node table"] == 0) {
+                cout << "Graph memory failed, missing parts\n" << r;
+                exit(1);
+            }
+        }
+        delete g;
+        if (t.current() != before) {
+            cout << "Graph memory failed, not all freed\n";
+            exit(1);
+        }
+    }
+    cout << "Graph memory passed\n";
+}
+
+template<class H>
+void verify_heap_memory(const string& name)
+{
+    memory::tracker& t = memory::global_tracker();
+    size_t before = t.current();
+    H* h = new H(10000, 100);
+    for (node_type n = 0; n < 10000; n++) h->insert(n % 100, n);
+    size_t measured = t.current() - before - sizeof(H);
+    check_close(name, h->memory_usage().total(), measured);
+    delete h;
+}
+
+void test_heap_memory()
+{
+    verify_heap_memory<heaps::dial_heap<unsigned int, node_type> >("Dial heap memory");
+    verify_heap_memory<heaps::radix_heap<unsigned int, node_type> >("Radix heap memory");
+    verify_heap_memory<pairing_heap<unsigned int, node_type> >("Pairing heap memory");
+    cout << "Heap memory passed\n";
+}
+
+void test_counting_allocator()
+{
+    memory::tracker own;
+    {
+        vector<int, memory::counting_allocator<int> > v{memory::counting_allocator<int>(own)};
+        v.reserve(100);
+        list<double, memory::counting_allocator<double> > l{memory::counting_allocator<double>(own)};
+        l.push_back(1.5);
+        if (own.current() != 100 * sizeof(int) + memory::memory_support::list_node_bytes<double>()) {
+            cout << "Counting allocator failed, " << own.current() << " bytes\n";
+            exit(1);
+        }
+    }
+    if (own.current() != 0 || own.peak() == 0) {
+        cout << "Counting allocator failed, not all freed\n";
+        exit(1);
+    }
+    cout << "Counting allocator passed\n";
+}
+
+void test_watch()
+{
+    weighted_graph_type g;
+    for (node_type n = 0; n < 20000; n++) g += {n, n + 1, 3};
+    size_t outer_peak;
+    {
+        memory::watch outer;
+        {
+            vector<char> big(1 << 20);
+        }
+        {
+            memory::watch inner;
+            dijkstra<weighted_graph_type, heaps::dial_heap>(g, 0);
+            // at least the costs and parents returned
+            if (inner.peak() < g.node_count() * (sizeof(unsigned int) + sizeof(node_type)) || inner.peak() >= (1 << 20)) {
+                cout << "Memory watch failed, inner peak " << inner.peak() << '\n';
+                exit(1);
+            }
+        }
+        outer_peak = outer.peak();
+    }
+    if (outer_peak < (1 << 20)) {
+        cout << "Memory watch failed, outer peak " << outer_peak << '\n';
+        exit(1);
+    }
+    cout << "Memory watch passed\n";
+}
+
+int main()
+{
+    cout << "Testing memory\n";
+    test_graph_memory();
+    test_heap_memory();
+    test_counting_allocator();
+    test_watch();
+}
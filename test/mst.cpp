@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "heaps.h"
+#include "parallel.h"
+#include "components.h"
+#include "mst.h"
+
+#include "graph_utils.h"
+
+using namespace std;
+using namespace graph;
+
+using weighted_graph_type = graph<weighted_edge<> >;
+using fractional_graph_type = graph<weighted_edge<double> >;
+
+// the forest must use edges of g, close no cycle, span every
+// component, and weigh what its edges add up to
+template<class G>
+void verify_forest(const string& name, const G& g, const spanning_forest<typename G::edge_type>& f)
+{
+    using node_type = typename G::node_type;
+    using weight_type = typename G::edge_type::weight_type;
+    mst_support::disjoint_sets<node_type> sets(g.node_count());
+    weight_type total = 0;
+    for (auto& e : f.edges) {
+        if (!g.contains_edge({e.source(), e.target()}) || !sets.unite(e.source(), e.target())) {
+            cout << name << " failed, bad edge " << e << '\n';
+            exit(1);
+        }
+        total += e.weight();
+    }
+    size_t trees = connected_components(g, 1).size();
+    if (f.edges.size() + trees != g.node_count() || fabs(static_cast<double>(total) - static_cast<double>(f.weight)) > 1e-6) {
+        cout << name << " failed, " << f.edges.size() << " edges for " << trees << " trees\n";
+        exit(1);
+    }
+}
+
+void test_mst()
+{
+    weighted_graph_type g {{0,1,4},{0,7,8},
+                           {1,2,8},{1,7,11},
+                           {2,3,7},{2,8,2},{2,5,4},
+                           {3,4,9},{3,5,14},
+                           {4,5,10},
+                           {5,6,2},
+                           {6,7,1},{6,8,6},
+                           {7,8,7},
+                           {9,10,3},{10,9,1},{10,10,0}};
+    // the first nine nodes, then 9 and 10 on their own
+    const unsigned long expected = 37 + 1;
+    spanning_forest<weighted_graph_type::edge_type> forests[] = {
+        prim(g), kruskal(g, 1), kruskal(g, 4), boruvka(g, 1), boruvka(g, 4)
+    };
+    for (auto& f : forests) {
+        verify_forest("Minimum spanning forest", g, f);
+        if (f.weight != expected) {
+            cout << "Minimum spanning forest failed, weight " << f.weight << '\n';
+            exit(1);
+        }
+    }
+    cout << "Minimum spanning forest passed\n";
+}
+
+void test_mst_random()
+{
+    mt19937 rnd(48);
+    for (int round = 0; round < 30; round++) {
+        // sometimes too sparse to be connected, and few distinct
+        // weights, so that many tie
+        unsigned int nodes = 20 + rnd() % 3000;
+        size_t edges = nodes / 2 + rnd() % (nodes * 4);
+        unsigned long weights = 1 + rnd() % 50;
+        weighted_graph_type g;
+        g += {nodes - 1, nodes - 1, 0};
+        for (size_t i = 0; i < edges; i++) {
+            unsigned int s = rnd() % nodes;
+            unsigned int t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t, rnd() % weights};
+        }
+        unsigned int threads = 1 + round % 4;
+        spanning_forest<weighted_graph_type::edge_type> p = prim(g);
+        spanning_forest<weighted_graph_type::edge_type> k = kruskal(g, threads);
+        spanning_forest<weighted_graph_type::edge_type> b = boruvka(g, threads);
+        verify_forest("Prim", g, p);
+        verify_forest("Kruskal", g, k);
+        verify_forest("Boruvka", g, b);
+        if (p.weight != k.weight || b.weight != k.weight) {
+            cout << "Minimum spanning forest random graphs failed, weights "
+                 << p.weight << ' ' << k.weight << ' ' << b.weight << '\n';
+            exit(1);
+        }
+    }
+    cout << "Minimum spanning forest random graphs passed\n";
+}
+
+void test_mst_fractional()
+{
+    mt19937 rnd(480);
+    uniform_real_distribution<double> weight(0.0, 10.0);
+    fractional_graph_type g;
+    for (unsigned int n = 0; n < 20000; n++) {
+        g += {n, n + 1, weight(rnd)};
+        unsigned int m = rnd() % 20001;
+        if (m != n && !g.contains_edge({n, m})) g += {n, m, weight(rnd)};
+    }
+    auto p = prim(g);
+    auto k = kruskal(g, 4);
+    auto b = boruvka(g, 4);
+    verify_forest("Prim, fractional", g, p);
+    verify_forest("Kruskal, fractional", g, k);
+    verify_forest("Boruvka, fractional", g, b);
+    if (fabs(p.weight - k.weight) > 1e-6 * k.weight || fabs(b.weight - k.weight) > 1e-6 * k.weight) {
+        cout << "Minimum spanning forest, fractional failed\n";
+        exit(1);
+    }
+    cout << "Minimum spanning forest, fractional passed\n";
+}
+
+void test_parallel_sort()
+{
+    mt19937 rnd(8);
+    for (size_t n : {10, 9000, 100000}) {
+        vector<unsigned int> values(n);
+        for (auto& v : values) v = rnd() % 1000;
+        vector<unsigned int> expected = values;
+        sort(expected.begin(), expected.end());
+        for (unsigned int threads : {1, 2, 3, 7}) {
+            vector<unsigned int> result = values;
+            parallel::parallel_sort(result.begin(), result.end(), less<unsigned int>(), threads);
+            if (result != expected) {
+                cout << "Parallel sort failed, " << n << " values on " << threads << " threads\n";
+                exit(1);
+            }
+        }
+    }
+    cout << "Parallel sort passed\n";
+}
+
+int main()
+{
+    cout << "Testing minimum spanning trees\n";
+    test_parallel_sort();
+    test_mst();
+    test_mst_random();
+    test_mst_fractional();
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <random>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "walks.h"
+#include "reachability.h"
+
+#include "graph_utils.h"
+
+using namespace std;
+using namespace graph;
+
+using basic_graph_type = graph<edge<>>;
+using node_type = basic_graph_type::node_type;
+
+// the nodes reachable from n, by a depth first walk
+vector<bool> walk_from(const basic_graph_type& g, node_type n)
+{
+    vector<bool> seen(g.node_count(), false);
+    dfw<basic_graph_type> walk{g};
+    walk.pre = [&](node_type m) { seen[m] = true; };
+    walk(g, n);
+    return seen;
+}
+
+void verify_reachability(const basic_graph_type& g, unsigned int threads)
+{
+    reachability_index<basic_graph_type> index{g, threads};
+    for (node_type a = 0; a < g.node_count(); a++) {
+        vector<bool> seen = walk_from(g, a);
+        for (node_type b = 0; b < g.node_count(); b++) {
+            if (index(a, b) != seen[b]) {
+                cout << "Reachability Failed!\n";
+                cout << a << " to " << b << " should be " << seen[b] << '\n';
+                print_graph(g);
+                exit(1);
+            }
+        }
+    }
+}
+
+void test_reachability()
+{
+    basic_graph_type g {{0,1}, {1,2}, {1,3},
+                       {1,4},
+                       {2,0},
+                       {3,0}, {3,5}, {3,7},
+                       {4,5},
+                       {5,6},
+                       {6,4},
+                       {7,5},
+                       {8,9}};
+    verify_reachability(g, 2);
+    cout << "Reachability passed\n";
+}
+
+void test_condensation()
+{
+    basic_graph_type g {{0,1}, {1,0}, {1,2}, {2,3}, {3,2}, {0,3}, {4,0}};
+    component_set<node_type> components = pearce_scc(g);
+    auto dag = condensation(g, components);
+    // {4} -> {0,1} -> {2,3}, with the two edges into {2,3} merged
+    if (dag.edge_count() != 2 || pearce_scc(dag).size() != dag.node_count()) {
+        cout << "Condensation Failed!\n";
+        print_graph(dag);
+        exit(1);
+    }
+    cout << "Condensation passed\n";
+}
+
+void test_reachability_random()
+{
+    mt19937 rnd(37);
+    for (int round = 0; round < 12; round++) {
+        // enough components to span several chunks
+        node_type nodes = 200 + rnd() % 1500;
+        size_t edges = nodes / 2 + rnd() % (nodes * 2);
+        basic_graph_type g;
+        g += {nodes - 1, nodes - 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t};
+        }
+        verify_reachability(g, 1 + round % 4);
+    }
+    cout << "Reachability random graphs passed\n";
+}
+
+// the index grows with the closure, not the number of components
+void test_reachability_sparse()
+{
+    basic_graph_type g;
+    node_type nodes = 300000;
+    g += {nodes - 1, nodes - 1};
+    // a few pairs far apart, one crossing many chunks
+    g += {100, 5};
+    g += {299000, 17};
+    g += {299000, 299001};
+    reachability_index<basic_graph_type> index{g, 3};
+    memory::report r = index.memory_usage();
+    if (r["rows"] > 16 * 1024 || index(5, 100) || !index(100, 5) || !index(299000, 17) ||
+        !index(299000, 299001) || index(299001, 299000) || index(17, 5) || !index(17, 17)) {
+        cout << "Reachability, sparse Failed!\n" << r;
+        exit(1);
+    }
+    cout << "Reachability, sparse passed\n";
+}
+
+int main()
+{
+    cout << "Testing reachability\n";
+    test_reachability();
+    test_condensation();
+    test_reachability_random();
+    test_reachability_sparse();
+}
@@ -1,4 +1,5 @@
 #include <tuple>
+#include <random>
 #include <string>
 #include <iostream>
 
@@ -6,6 +7,9 @@
 #include "edge.h"
 #include "shortest_paths.h"
 #include "heaps.h"
+#include "dynamic_paths.h"
+#include "distance_tables.h"
+#include "stats.h"
 
 #include "graph_utils.h"
 
@@ -16,7 +20,7 @@ using namespace heaps;
 
 template<class G>
 pair<bool, string> verify_shortest_paths(const G& g,
-                                         vector<typename G::edge_type::weight_type> weights,
+                                         vector<typename edge_weights<typename G::edge_type>::cost_type> weights,
                                          vector<typename G::node_type> parents)
 {
     for (auto e : g) {
@@ -35,7 +39,7 @@ pair<bool, string> verify_shortest_paths(const G& g,
 template<class G, class S>
 void verify_graph(string name, const G& g, const S& fun)
 {
-    vector<typename G::edge_type::weight_type> weights;
+    vector<typename edge_weights<typename G::edge_type>::cost_type> weights;
     vector<typename G::node_type> parents;
     tie (weights, parents) = fun(g, 0);
     bool success;
@@ -70,6 +74,34 @@ void fail_on_cycle(string name, const G& g, const S& fun) {
     exit(1);
 }
 
+template<class G, class S>
+void find_cycle(string name, const G& g, const S& fun) {
+    using node_type = typename G::node_type;
+    try {
+        fun(g,0);
+    } catch (negative_cycle_path<node_type>& found) {
+        typename G::edge_type::weight_type total = 0;
+        for (size_t i = 0; i < found.cycle.size(); i++) {
+            node_type s = found.cycle[i];
+            node_type t = found.cycle[(i + 1) % found.cycle.size()];
+            if (!g.contains_edge({s,t})) {
+                cout << name << " failed, no edge " << s << ',' << t << " on cycle\n";
+                exit(1);
+            }
+            total += g.edge_at({s,t}).weight();
+        }
+        if (total >= 0) {
+            cout << name << " failed, cycle cost " << total << " is not negative\n";
+            exit(1);
+        }
+        cout << name << " passed\n";
+        return;
+    }
+    cout << name << " failed, cycle not found\n";
+    print_graph(g);
+    exit(1);
+}
+
 using positive_graph_type = graph<weighted_edge<> >;
 
 positive_graph_type positive_graph {{0,1,2},{0,2,8},
@@ -89,6 +121,25 @@ fractional_graph_type fractional_graph {{0,1,2.4},{0,2,8.7},
                                         {5,4,2.4}};
 
 
+using unit_graph_type = graph<edge<> >;
+
+unit_graph_type unit_graph {{0,1},{0,2},
+                            {1,2},{1,3},
+                            {2,1},{2,4},
+                            {3,2},{3,4},{3,5},
+                            {4,3},{4,6},
+                            {5,4},{5,7},
+                            {6,7},{7,8}};
+
+using zero_one_graph_type = graph<weighted_edge<bool> >;
+
+zero_one_graph_type zero_one_graph {{0,1,1},{0,2,0},
+                                    {1,2,1},{1,3,1},
+                                    {2,1,0},{2,4,1},
+                                    {3,2,0},{3,4,1},{3,5,0},
+                                    {4,3,1},
+                                    {5,4,0}};
+
 using negative_graph_type = graph<weighted_edge<long> >;
 
 negative_graph_type negative_graph {{1,2,10},{1,3,15},
@@ -106,6 +157,213 @@ negative_graph_type negative_graph_cycle {{1,2,10},{1,3,15},
                                           {0,1,0}};
 
 
+template<class U, class S>
+void verify_unit_graph(string name, const U& u, const S& fun)
+{
+    // the same graph, with weight one on every edge, for dijkstra
+    positive_graph_type w;
+    for (auto e : u) w += {e.source(), e.target(), 1};
+    vector<positive_graph_type::edge_type::weight_type> expected;
+    tie(expected, ignore) = dijkstra<positive_graph_type,dial_heap>(w, 0);
+    vector<typename U::node_type> costs;
+    vector<typename U::node_type> parents;
+    tie(costs, parents) = fun(u, 0);
+    for (auto e : w) {
+        if (costs[e.target()] != expected[e.target()] ||
+            (parents[e.target()] == e.source() && costs[e.source()] + 1 != costs[e.target()])) {
+            cout << name << " failed at edge " << string(e) << '\n';
+            exit(1);
+        }
+    }
+    cout << name << " passed\n";
+}
+
+template<class G>
+void test_dynamic_paths(string name,
+                        G g,
+                        vector<edge_update<typename G::edge_type> > batch)
+{
+    dynamic_paths<G> paths{g, 0};
+    paths.apply(batch);
+    vector<typename G::edge_type::weight_type> expected;
+    tie(expected, ignore) = dijkstra<G,pairing_heap>(g, 0);
+    if (paths.costs() != expected) {
+        cout << name << " failed, costs differ from dijkstra\n";
+        print_graph(g);
+        exit(1);
+    }
+    verify_graph(name, g, [&](const G&, typename G::node_type) {
+            return make_pair(paths.costs(), paths.parents());
+        });
+}
+
+template<template<class,class> class H, class G>
+void test_distance_table(string name,
+                         const G& g,
+                         vector<typename G::node_type> sources,
+                         vector<typename G::node_type> targets)
+{
+    using weight_type = typename G::edge_type::weight_type;
+    vector<weight_type> table = distance_table<G,H>(g, sources, targets);
+    for (size_t i = 0; i < sources.size(); i++) {
+        vector<weight_type> costs;
+        tie(costs, ignore) = dijkstra<G,dial_heap>(g, sources[i]);
+        for (size_t j = 0; j < targets.size(); j++) {
+            if (table[i * targets.size() + j] != costs[targets[j]]) {
+                cout << name << " failed from " << sources[i] << " to " << targets[j] << '\n';
+                exit(1);
+            }
+        }
+    }
+    cout << name << " passed\n";
+}
+
+template<class G>
+void test_nearest_source(string name,
+                         const G& g,
+                         vector<typename G::node_type> sources)
+{
+    using weight_type = typename G::edge_type::weight_type;
+    vector<weight_type> costs;
+    vector<typename G::node_type> parents;
+    vector<typename G::node_type> labels;
+    tie(costs, parents, labels) = nearest_source<G,dial_heap>(g, sources);
+    for (typename G::node_type n = 0; n < g.node_count(); n++) {
+        vector<weight_type> from_label(g.node_count(), numeric_limits<weight_type>::max());
+        if (labels[n] != numeric_limits<typename G::node_type>::max()) {
+            tie(from_label, ignore) = dijkstra<G,dial_heap>(g, labels[n]);
+        }
+        for (auto s : sources) {
+            vector<weight_type> from_s;
+            tie(from_s, ignore) = dijkstra<G,dial_heap>(g, s);
+            if (from_s[n] < costs[n] || from_label[n] != costs[n]) {
+                cout << name << " failed at node " << n << '\n';
+                exit(1);
+            }
+        }
+    }
+    cout << name << " passed\n";
+}
+
+// the counts that hold for any heap, with every node reachable
+template<template<class,class> class H>
+void verify_dijkstra_stats(string name)
+{
+    using weight_type = positive_graph_type::edge_type::weight_type;
+    stats::count_stats counted;
+    vector<weight_type> costs, expected;
+    tie(costs, ignore) = dijkstra<positive_graph_type,H>(positive_graph, 0, 8, counted);
+    tie(expected, ignore) = dijkstra<positive_graph_type,H>(positive_graph, 0, 8);
+    const stats::counters& c = counted.counts;
+    if (costs != expected ||
+        c.nodes_settled != positive_graph.node_count() ||
+        c.heap_delete_mins != c.nodes_settled ||
+        c.heap_inserts != c.nodes_settled ||
+        c.edges_scanned != positive_graph.edge_count() ||
+        c.relaxations != c.heap_inserts - 1 + c.heap_decrease_keys ||
+        c.queue_reentries != 0) {
+        cout << name << " failed\n";
+        c.for_each([](const char* counter, unsigned long value) { cout << counter << ' ' << value << '\n'; });
+        exit(1);
+    }
+}
+
+void test_stats()
+{
+    verify_dijkstra_stats<dial_heap>("Dijkstra (dial) stats");
+    verify_dijkstra_stats<radix_heap>("Dijkstra (radix) stats");
+    verify_dijkstra_stats<pairing_heap>("Dijkstra (pairing) stats");
+
+    // the first step from 0 costs 2, so the base must move
+    stats::count_stats dial;
+    dijkstra<positive_graph_type,dial_heap>(positive_graph, 0, 8, dial);
+    if (dial.counts.heap_rebases == 0 || dial.counts.heap_redistributions != 0) {
+        cout << "Dijkstra (dial) stats failed, rebases\n";
+        exit(1);
+    }
+
+    // each node after the first time through the queue is a reentry
+    stats::count_stats q, dq;
+    q_lc(negative_graph, 0, q);
+    dq_lc(negative_graph, 0, dq);
+    for (const stats::counters* c : {&q.counts, &dq.counts}) {
+        if (c->nodes_settled != negative_graph.node_count() + c->queue_reentries ||
+            c->queue_reentries == 0 ||
+            c->relaxations == 0 ||
+            c->heap_inserts != 0) {
+            cout << "Label correcting stats failed\n";
+            exit(1);
+        }
+    }
+    if (q_lc(negative_graph, 0, q) != q_lc(negative_graph, 0)) {
+        cout << "Label correcting stats failed, results differ\n";
+        exit(1);
+    }
+
+    // counts add up across calls until cleared
+    stats::counters total = q.counts;
+    total += dq.counts;
+    q.clear();
+    if (q.counts.nodes_settled != 0 || total.nodes_settled == 0) {
+        cout << "Stats clear failed\n";
+        exit(1);
+    }
+    cout << "Stats passed\n";
+}
+
+// repeated edges sit in the lists but count once in edge_count()
+void test_bfs_repeated_edges()
+{
+    unit_graph_type g;
+    for (unit_graph_type::node_type n = 0; n < 300; n++) {
+        for (int i = 0; i < 3; i++) g += {n, (n * 7 + 1) % 300};
+        g += {n, (n + 1) % 300};
+    }
+    if (bfs_paths(g, reverse(g), 0).first != bfs_paths(g, 0).first) {
+        cout << "BFS (direction optimizing), repeated edges failed\n";
+        exit(1);
+    }
+    cout << "BFS (direction optimizing), repeated edges passed\n";
+}
+
+// large enough that each round's frontier spans many bitmap chunks,
+// so par_bf's relaxations really run on several threads
+void test_par_bf_large()
+{
+    using node_type = negative_graph_type::node_type;
+    mt19937 rnd(26);
+    node_type nodes = 20000;
+    // weights shifted by a potential, so some are negative but no
+    // cycle is
+    vector<long> potential(nodes);
+    for (auto& p : potential) p = rnd() % 50;
+    negative_graph_type g;
+    for (node_type s = 0; s < nodes; s++) {
+        for (int i = 0; i < 5; i++) {
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t, static_cast<long>(rnd() % 20) + potential[s] - potential[t]};
+        }
+    }
+    // some nodes are unreached, so check parents here rather than
+    // with verify_shortest_paths, whose sums would overflow
+    const long unreached = numeric_limits<long>::max();
+    auto expected = q_lc(g, 0);
+    for (unsigned int threads : {2, 4, 7}) {
+        auto result = par_bf(g, 0, threads);
+        bool failed = result.first != expected.first;
+        for (node_type n = 1; n < nodes && !failed; n++) {
+            if (result.first[n] == unreached) continue;
+            node_type p = result.second[n];
+            failed = !g.contains_edge({p, n}) || result.first[p] + g.edge_at({p, n}).weight() != result.first[n];
+        }
+        if (failed) {
+            cout << "Parallel Bellman-Ford, large failed on " << threads << " threads\n";
+            exit(1);
+        }
+    }
+    cout << "Parallel Bellman-Ford, large passed\n";
+}
+
 int main()
 {
     cout << "Testing shortest path algorithms\n";
@@ -133,6 +391,42 @@ int main()
     auto f_dq_lc_n = [](const negative_graph_type& g, negative_graph_type::node_type n) {
         return dq_lc(g,n);
     };
+    auto f_tarjan_lc = [](const positive_graph_type& g, positive_graph_type::node_type n) {
+        return tarjan_lc(g,n);
+    };
+    auto f_tarjan_lc_fifo = [](const positive_graph_type& g, positive_graph_type::node_type n) {
+        return tarjan_lc(g,n,lc_queue::fifo);
+    };
+    auto f_tarjan_lc_n = [](const negative_graph_type& g, negative_graph_type::node_type n) {
+        return tarjan_lc(g,n);
+    };
+    auto f_tarjan_lc_slf_n = [](const negative_graph_type& g, negative_graph_type::node_type n) {
+        return tarjan_lc(g,n,lc_queue::slf);
+    };
+    auto f_tarjan_lc_lll_n = [](const negative_graph_type& g, negative_graph_type::node_type n) {
+        return tarjan_lc(g,n,lc_queue::lll);
+    };
+    auto f_zero_one = [](const zero_one_graph_type& g, zero_one_graph_type::node_type n) {
+        return zero_one_bfs(g,n);
+    };
+    auto f_sssp_zero_one = [](const zero_one_graph_type& g, zero_one_graph_type::node_type n) {
+        return sssp(g,n);
+    };
+    auto f_bfs = [](const unit_graph_type& g, unit_graph_type::node_type n) {
+        return bfs_paths(g,n);
+    };
+    auto f_bfs_beamer = [](const unit_graph_type& g, unit_graph_type::node_type n) {
+        return bfs_paths(g,reverse(g),n,1,1);
+    };
+    auto f_sssp_unit = [](const unit_graph_type& g, unit_graph_type::node_type n) {
+        return sssp(g,n);
+    };
+    auto f_par_bf = [](const positive_graph_type& g, positive_graph_type::node_type n) {
+        return par_bf(g,n,4);
+    };
+    auto f_par_bf_n = [](const negative_graph_type& g, negative_graph_type::node_type n) {
+        return par_bf(g,n,4);
+    };
 
     verify_graph("Dijkstra (dial)", positive_graph, f_dijkstra_dial);
     verify_graph("Dijkstra (radix)", positive_graph, f_dijkstra_radix);
@@ -142,5 +436,42 @@ int main()
     verify_graph("Deque label correcting", positive_graph, f_dq_lc);
     verify_graph("Queued label correcting, negative", negative_graph, f_q_lc_n);
     verify_graph("Deque label correcting, negative", negative_graph, f_dq_lc_n);
+    verify_graph("Tarjan label correcting", positive_graph, f_tarjan_lc);
+    verify_graph("Tarjan label correcting (fifo)", positive_graph, f_tarjan_lc_fifo);
+    verify_graph("Tarjan label correcting, negative", negative_graph, f_tarjan_lc_n);
+    verify_graph("Tarjan label correcting (slf), negative", negative_graph, f_tarjan_lc_slf_n);
+    verify_graph("Tarjan label correcting (lll), negative", negative_graph, f_tarjan_lc_lll_n);
+    verify_graph("0-1 BFS", zero_one_graph, f_zero_one);
+    verify_graph("Shortest paths, 0-1 weights", zero_one_graph, f_sssp_zero_one);
+    verify_unit_graph("BFS", unit_graph, f_bfs);
+    verify_unit_graph("BFS (direction optimizing)", unit_graph, f_bfs_beamer);
+    verify_unit_graph("Shortest paths, unit weights", unit_graph, f_sssp_unit);
+    test_bfs_repeated_edges();
+    verify_graph("Parallel Bellman-Ford", positive_graph, f_par_bf);
+    verify_graph("Parallel Bellman-Ford, negative", negative_graph, f_par_bf_n);
     fail_on_cycle("Queued label correcting, cycle", negative_graph_cycle, f_q_lc_n);
+    fail_on_cycle("Parallel Bellman-Ford, cycle", negative_graph_cycle, f_par_bf_n);
+    test_par_bf_large();
+    test_stats();
+    find_cycle("Tarjan label correcting, cycle", negative_graph_cycle, f_tarjan_lc_n);
+
+    test_distance_table<dial_heap>("Distance table", positive_graph, {0, 3, 5, 1}, {4, 2, 0, 5, 4});
+    // each thread's heap is cleared and reused, after searches that
+    // stopped early and ones that ran out
+    test_distance_table<radix_heap>("Distance table (radix)", positive_graph, {0, 3, 5, 1, 0}, {1, 0});
+    test_distance_table<pairing_heap>("Distance table (pairing)", positive_graph, {2, 4, 2, 0}, {0, 1, 2, 3, 4, 5});
+    test_distance_table<dial_heap>("Distance table, no targets", positive_graph, {0, 3}, {});
+    test_nearest_source("Nearest source", positive_graph, {1, 5});
+
+    using edge_type = positive_graph_type::edge_type;
+    test_dynamic_paths("Dynamic paths, insert", positive_graph,
+                       {{edge_change::insert, edge_type{0,4,1}},
+                        {edge_change::insert, edge_type{4,6,1}}});
+    test_dynamic_paths("Dynamic paths, remove", positive_graph,
+                       {{edge_change::remove, edge_type{1,3,0}},
+                        {edge_change::remove, edge_type{0,1,0}}});
+    test_dynamic_paths("Dynamic paths, reweight", positive_graph,
+                       {{edge_change::reweight, edge_type{0,1,9}},
+                        {edge_change::reweight, edge_type{3,5,1}},
+                        {edge_change::reweight, edge_type{2,4,3}}});
 }
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "graph.h"
+#include "edge.h"
+#include "trace.h"
+#include "parallel.h"
+#include "walks.h"
+#include "components.h"
+#include "shortest_paths.h"
+#include "random_graphs.h"
+
+using namespace std;
+using namespace graph;
+
+using basic_graph_type = graph<edge<>>;
+using node_type = basic_graph_type::node_type;
+
+size_t count_named(const vector<trace::event>& events, const string& name)
+{
+    return count_if(events.begin(), events.end(), [&](const trace::event& e) { return name == e.name; });
+}
+
+void test_trace_off()
+{
+    trace::disable();
+    trace::clear();
+    {
+        trace::span s{"off"};
+    }
+    basic_graph_type g {{0,1},{1,2}};
+    top_sort(g);
+    if (!trace::events().empty() || trace::current() != nullptr) {
+        cout << "Trace off failed, spans recorded\n";
+        exit(1);
+    }
+    cout << "Trace off passed\n";
+}
+
+void test_trace_spans()
+{
+    trace::clear();
+    trace::enable();
+    {
+        trace::span outer{"outer", "test"};
+        if (string(trace::current()) != "outer") {
+            cout << "Trace spans failed, current\n";
+            exit(1);
+        }
+        {
+            trace::span inner{"inner", "test"};
+        }
+        if (string(trace::current()) != "outer") {
+            cout << "Trace spans failed, current restored\n";
+            exit(1);
+        }
+    }
+    trace::disable();
+    vector<trace::event> events = trace::events();
+    if (events.size() != 2 || string(events[0].name) != "outer" || string(events[1].name) != "inner" ||
+        events[1].start < events[0].start ||
+        events[1].start + events[1].duration > events[0].start + events[0].duration ||
+        trace::current() != nullptr) {
+        cout << "Trace spans failed, nesting\n";
+        exit(1);
+    }
+    cout << "Trace spans passed\n";
+}
+
+void test_trace_pipeline()
+{
+    trace::clear();
+    trace::enable();
+    auto plain = [](node_type s, node_type t) { return edge<>{s, t}; };
+    basic_graph_type g = rnd_rmat<basic_graph_type>(10, 8, 0.57, 0.19, 0.19, plain, 7, 2);
+    basic_graph_type r = reverse(g);
+    par_scc(g, r, 4, 0);
+    bfs_paths(g, 0);
+    trace::disable();
+
+    vector<trace::event> events = trace::events();
+    for (const char* name : {"rnd_rmat", "reverse", "par_scc", "bfs_paths"}) {
+        if (count_named(events, name) == 0) {
+            cout << "Trace pipeline failed, no span for " << name << '\n';
+            exit(1);
+        }
+    }
+    // the threads par_scc started are named after it
+    vector<unsigned int> threads;
+    for (auto& e : events) if (string(e.name) == "par_scc") threads.push_back(e.thread);
+    sort(threads.begin(), threads.end());
+    threads.erase(unique(threads.begin(), threads.end()), threads.end());
+    if (threads.size() < 2) {
+        cout << "Trace pipeline failed, worker threads missing\n";
+        exit(1);
+    }
+
+    ostringstream json;
+    trace::write_chrome_json(json);
+    string text = json.str();
+    if (text.find("\"traceEvents\":[") == string::npos ||
+        text.find("\"name\":\"par_scc\",\"cat\":\"graph\",\"ph\":\"X\"") == string::npos ||
+        text.find("\"thread_name\"") == string::npos ||
+        text.substr(text.size() - 3) != "]}\n") {
+        cout << "Trace pipeline failed, bad json\n";
+        cout << text.substr(0, 400) << '\n';
+        exit(1);
+    }
+    cout << "Trace pipeline passed\n";
+}
+
+void test_trace_ring()
+{
+    trace::clear();
+    size_t old = trace::capacity();
+    trace::set_capacity(8);
+    trace::enable();
+    for (int i = 0; i < 20; i++) {
+        trace::span s{i < 10 ? "early" : "late"};
+    }
+    trace::disable();
+    trace::set_capacity(old);
+    vector<trace::event> events = trace::events();
+    if (events.size() != 8 || count_named(events, "late") != 8 || trace::dropped() != 12) {
+        cout << "Trace ring failed\n";
+        exit(1);
+    }
+    cout << "Trace ring passed\n";
+}
+
+void test_trace_threads()
+{
+    // the threads of each call end before the next starts, and hand
+    // their rings on, so the thread numbers stay few
+    trace::clear();
+    trace::enable();
+    for (int i = 0; i < 200; i++) {
+        trace::span s{"call"};
+        parallel::parallel_do(4, [](unsigned int) { trace::span w{"work"}; });
+    }
+    trace::disable();
+    vector<trace::event> events = trace::events();
+    vector<unsigned int> threads;
+    for (auto& e : events) threads.push_back(e.thread);
+    sort(threads.begin(), threads.end());
+    threads.erase(unique(threads.begin(), threads.end()), threads.end());
+    if (count_named(events, "work") < 800 || threads.size() > 8) {
+        cout << "Trace threads failed, " << threads.size() << " thread numbers\n";
+        exit(1);
+    }
+    cout << "Trace threads passed\n";
+}
+
+int main()
+{
+    cout << "Testing trace\n";
+    test_trace_off();
+    test_trace_spans();
+    test_trace_pipeline();
+    test_trace_ring();
+    test_trace_threads();
+}
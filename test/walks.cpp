@@ -1,10 +1,13 @@
 #include <algorithm>
+#include <random>
+#include <atomic>
 #include <string>
 #include <iostream>
 
 #include "graph.h"
 #include "edge.h"
 #include "walks.h"
+#include "dynamic_order.h"
 
 #include "graph_utils.h"
 
@@ -54,7 +57,14 @@ void test_top_sort_cycle()
     using node_type = basic_graph_type::node_type;
     try {
         vector<node_type> result = top_sort(g);
-    } catch (cycle_found<edge_type>) {
+    } catch (cycle_found<edge_type>& found) {
+        // the parents lead from the back edge's source round to its target
+        node_type n = found.edge.source();
+        while (n != found.edge.target() && n != numeric_limits<node_type>::max()) n = found.parents[n];
+        if (n != found.edge.target()) {
+            cout << "Topological Sort failed, cycle not in parents\n";
+            exit(1);
+        }
         cout << "Topological Sort Cycle Detection passed\n";
         return;
     }
@@ -78,8 +88,8 @@ void test_scc()
     result_type expected{{ 0, 1, 2, 3 },
                          { 7 },
                          { 4, 5, 6 }};
-    auto same = [](component a, component b) { return is_permutation(a.begin(), a.end(), b.begin()); };
-    if ( !is_permutation(result.begin(), result.end(), expected.begin(), same) ) {
+    auto same = [](component a, component b) { return a.size() == b.size() && is_permutation(a.begin(), a.end(), b.begin()); };
+    if (result.size() != expected.size() || !is_permutation(result.begin(), result.end(), expected.begin(), same)) {
         auto print = [](result_type r) {
             for (auto c : r) {
                 for (auto n : c) cout << n << ' ';
@@ -99,10 +109,306 @@ void test_scc()
     }
 }
 
+void test_pearce_scc()
+{
+    basic_graph_type g {{0,1}, {1,2}, {1,3},
+                       {1,4},
+                       {2,0},
+                       {3,0}, {3,5}, {3,7},
+                       {4,5},
+                       {5,6},
+                       {6,4},
+                       {7,5}};
+    using node_type = basic_graph_type::node_type;
+    using component = vector<node_type>;
+    component_set<node_type> result = pearce_scc(g);
+    vector<component> expected{{ 0, 1, 2, 3 },
+                               { 7 },
+                               { 4, 5, 6 }};
+    bool failed = result.size() != expected.size();
+    for (size_t c = 0; !failed && c < result.size(); c++) {
+        component found(result.begin(c), result.end(c));
+        auto same = [&](const component& e) { return found.size() == e.size() && is_permutation(found.begin(), found.end(), e.begin()); };
+        if (find_if(expected.begin(), expected.end(), same) == expected.end()) failed = true;
+        for (node_type n : found) if (result.ids[n] != c) failed = true;
+    }
+    for (auto e : g) {
+        if (result.ids[e.source()] < result.ids[e.target()]) failed = true;
+    }
+    if (failed) {
+        cout << "Pearce SCC Failed!\n";
+        print_graph(g);
+        for (size_t c = 0; c < result.size(); c++) {
+            for (auto n = result.begin(c); n != result.end(c); n++) cout << *n << ' ';
+            cout << '\n';
+        }
+        exit(1);
+    }
+    cout << "Pearce SCC passed\n";
+}
+
+template<class G>
+class class_counter : public dfw_visitor<G> {
+public:
+    vector<int> counts = vector<int>(4, 0);
+    void edge(const typename G::edge_type&, edge_class c) { counts[static_cast<int>(c)]++; }
+};
+
+void test_static_walk()
+{
+    basic_graph_type g {{0,1},{0,2},{0,3},{1,3},{2,0},{3,4},{4,1},{5,4},{5,0}};
+    using node_type = basic_graph_type::node_type;
+    vector<int> expected(4, 0);
+    dfw<basic_graph_type> walk{g};
+    walk.edge = [&](basic_graph_type::edge_type e) { expected[static_cast<int>(walk.classify_edge(e))]++; };
+    class_counter<basic_graph_type> counter;
+    static_dfw<basic_graph_type, class_counter<basic_graph_type> > static_walk{g, counter};
+    for (node_type n = 0; n < g.node_count(); n++) {
+        if (!walk.processed(n)) walk(g,n);
+        if (!static_walk.processed(n)) static_walk(g,n);
+    }
+    if (counter.counts != expected) {
+        cout << "Static walk failed, edge classes differ\n";
+        exit(1);
+    }
+    cout << "Static walk passed\n";
+}
+
+void test_walk_stats()
+{
+    basic_graph_type g {{0,1},{0,2},{0,3},{1,3},{2,0},{3,4},{4,1},{5,4},{5,0},{6,6}};
+    using node_type = basic_graph_type::node_type;
+    dfw<basic_graph_type, stats::count_stats> walk{g};
+    for (node_type n = 0; n < g.node_count(); n++) {
+        if (!walk.processed(n)) walk(g,n);
+    }
+    if (walk.stats.counts.nodes_settled != g.node_count() ||
+        walk.stats.counts.edges_scanned != g.edge_count() ||
+        walk.stats.counts.heap_inserts != 0) {
+        cout << "Walk stats failed\n";
+        exit(1);
+    }
+    cout << "Walk stats passed\n";
+}
+
+void test_deep_walk()
+{
+    // deep enough to overflow the stack of a recursive walk
+    using node_type = basic_graph_type::node_type;
+    const node_type length = 500000;
+    basic_graph_type g;
+    for (node_type n = 0; n < length; n++) g += {n, n + 1};
+    vector<node_type> results = top_sort(g);
+    for (node_type n = 0; n <= length; n++) {
+        if (results[n] != length - n) {
+            cout << "Deep walk failed at " << n << '\n';
+            exit(1);
+        }
+    }
+    if (scc(g, reverse(g)).size() != length + 1 || pearce_scc(g).size() != length + 1) {
+        cout << "Deep walk failed, wrong scc count\n";
+        exit(1);
+    }
+    cout << "Deep walk passed\n";
+}
+
+void test_top_levels()
+{
+    basic_graph_type g {{0,2},{0,12},
+                       {1,4},{1,2},{1,8},
+                       {2,7},
+                       {3,8},{3,13},{3,6},
+                       {4,7},
+                       {5,0},{5,4},{5,11},
+                       {8,0},{8,9},{8,13},
+                       {9,11},{9,10},
+                       {10,6},
+                       {12,9},
+                       {13,0}};
+    using node_type = basic_graph_type::node_type;
+    vector<vector<node_type> > expected{{1, 3, 5},
+                                        {4, 8},
+                                        {13},
+                                        {0},
+                                        {2, 12},
+                                        {7, 9},
+                                        {10, 11},
+                                        {6}};
+    for (unsigned int threads : {1, 3}) {
+        vector<vector<node_type> > levels = top_levels(g, threads);
+        if (levels != expected) {
+            cout << "Topological Levels Failed!\n";
+            for (auto& level : levels) {
+                for (auto n : level) cout << n << ' ';
+                cout << '\n';
+            }
+            exit(1);
+        }
+    }
+    cout << "Topological Levels passed\n";
+}
+
+// a long chain, with one wide level part way along; bench times it
+// on one thread and many
+void test_top_levels_chain()
+{
+    using node_type = basic_graph_type::node_type;
+    const node_type length = 100000;
+    const node_type width = 5000;
+    basic_graph_type g;
+    for (node_type n = 0; n + 1 < length; n++) g += {n, n + 1};
+    for (node_type w = length; w < length + width; w++) {
+        g += {1000, w};
+        g += {w, 1001};
+    }
+    for (unsigned int threads : {1, 8}) {
+        vector<vector<node_type> > levels = top_levels(g, threads);
+        // the wide level sits between 1000 and 1001, pushing the rest
+        // of the chain one level down
+        if (levels.size() != length + 1 || levels[1001].size() != width || levels[1002] != vector<node_type>{1001}) {
+            cout << "Topological Levels, long chain Failed! " << levels.size() << " levels\n";
+            exit(1);
+        }
+    }
+    cout << "Topological Levels, long chain passed\n";
+}
+
+void test_top_levels_cycle()
+{
+    // 5 -> 6 -> 7 -> 5 feeds the cycle 2 -> 3 -> 4 -> 2
+    basic_graph_type g {{0,1},{1,2},{2,3},{3,4},{4,2},{4,8},{5,6},{6,7},{7,5},{7,3}};
+    using edge_type = basic_graph_type::edge_type;
+    using node_type = basic_graph_type::node_type;
+    try {
+        top_levels(g, 2);
+    } catch (cyclic_component<edge_type>& found) {
+        vector<node_type> expected{5, 6, 7};
+        node_type n = found.edge.source();
+        while (n != found.edge.target() && n != numeric_limits<node_type>::max()) n = found.parents[n];
+        if (found.component != expected || n != found.edge.target()) {
+            cout << "Topological Levels Cycle Failed, wrong component\n";
+            exit(1);
+        }
+        cout << "Topological Levels Cycle passed\n";
+        return;
+    }
+    cout << "Topological Levels Cycle Failed, no cycle found\n";
+    exit(1);
+}
+
+void test_dynamic_top_order()
+{
+    using edge_type = basic_graph_type::edge_type;
+    using node_type = basic_graph_type::node_type;
+    mt19937 rnd(36);
+    const node_type nodes = 300;
+    basic_graph_type g{{0, 1}};
+    dynamic_top_order<basic_graph_type> order{g};
+    size_t rejected = 0;
+    for (int i = 0; i < 3000; i++) {
+        node_type s = rnd() % nodes;
+        node_type t = rnd() % nodes;
+        if (s < g.node_count() && t < g.node_count() && g.contains_edge({s, t})) continue;
+        try {
+            order += edge_type{s, t};
+        } catch (cycle_found<edge_type>& found) {
+            // the edge is refused only if it closes a cycle of g
+            node_type n = found.edge.source();
+            size_t steps = 0;
+            while (n != found.edge.target() && n != numeric_limits<node_type>::max() && steps++ < nodes) {
+                if (!g.contains_edge({found.parents[n], n})) break;
+                n = found.parents[n];
+            }
+            if (n != found.edge.target() || g.contains_edge({s, t})) {
+                cout << "Dynamic Topological Order Failed, bad cycle\n";
+                exit(1);
+            }
+            rejected++;
+        }
+        for (auto e : g) {
+            if (order.position(e.source()) >= order.position(e.target())) {
+                cout << "Dynamic Topological Order Failed at " << e << '\n';
+                exit(1);
+            }
+        }
+    }
+    for (node_type i = 0; i < order.order().size(); i++) {
+        if (order.position(order.order()[i]) != i) {
+            cout << "Dynamic Topological Order Failed, positions out of step\n";
+            exit(1);
+        }
+    }
+    if (rejected == 0) {
+        cout << "Dynamic Topological Order Failed, no cycles refused\n";
+        exit(1);
+    }
+    cout << "Dynamic Topological Order passed\n";
+}
+
+void test_bfw()
+{
+    using node_type = basic_graph_type::node_type;
+    const node_type token = numeric_limits<node_type>::max();
+    mt19937 rnd(39);
+    for (int round = 0; round < 20; round++) {
+        node_type nodes = 100 + rnd() % 20000;
+        size_t edges = rnd() % (nodes * 3);
+        basic_graph_type g;
+        g += {nodes - 1, nodes - 1};
+        for (size_t i = 0; i < edges; i++) {
+            node_type s = rnd() % nodes;
+            node_type t = rnd() % nodes;
+            if (!g.contains_edge({s, t})) g += {s, t};
+        }
+        vector<node_type> sources{static_cast<node_type>(rnd() % nodes), static_cast<node_type>(rnd() % nodes)};
+
+        // a plain serial walk to compare against
+        vector<node_type> expected(nodes, token);
+        vector<node_type> queue;
+        for (node_type s : sources) {
+            if (expected[s] == token) queue.push_back(s);
+            expected[s] = 0;
+        }
+        for (size_t i = 0; i < queue.size(); i++) {
+            for (auto& e : g[queue[i]]) {
+                if (expected[e.target()] != token) continue;
+                expected[e.target()] = expected[queue[i]] + 1;
+                queue.push_back(e.target());
+            }
+        }
+
+        // one node chunks leave threads idle on the narrow levels
+        bfw<basic_graph_type> walk(g, 1 + round % 8);
+        walk.chunk_size = round % 2 ? 16 : 1;
+        atomic<size_t> visits{0};
+        walk(g, sources, [&](node_type, node_type, node_type) { visits++; });
+        bool failed = walk.hops != expected || visits != queue.size();
+        for (node_type n = 0; n < nodes; n++) {
+            if (walk.hops[n] == 0 || walk.hops[n] == token) continue;
+            node_type p = walk.parents[n];
+            if (!g.contains_edge({p, n}) || walk.hops[p] + 1 != walk.hops[n]) failed = true;
+        }
+        if (failed) {
+            cout << "Breadth First Walk Failed!\n";
+            exit(1);
+        }
+    }
+    cout << "Breadth First Walk passed\n";
+}
+
 int main()
 {
     cout << "Testing walks\n";
     test_top_sort();
     test_top_sort_cycle();
     test_scc();
+    test_pearce_scc();
+    test_static_walk();
+    test_walk_stats();
+    test_deep_walk();
+    test_bfw();
+    test_top_levels();
+    test_top_levels_chain();
+    test_top_levels_cycle();
+    test_dynamic_top_order();
 }